@@ -42,6 +42,22 @@ typedef struct
  */
 void BUTTON_Init(BUTTON_TypeDef *BUTTONx);
 
+/*
+ * Function: BUTTON_InitInterrupt
+ * ----------------------------
+ *   Initialize the Button Pin as an external interrupt source.
+ *
+ *   This function configures the button pin like BUTTON_Init() (input with internal
+ *   pull-up) but also routes it to its EXTI line, triggering on both the press (falling)
+ *   and the release (rising) edge. The matching EXTIx_IRQn must be enabled in the NVIC
+ *   by the application.
+ *
+ *   BUTTONx: A pointer to the Button structure containing the port and pin information.
+ *
+ *   Returns: None
+ */
+void BUTTON_InitInterrupt(BUTTON_TypeDef *BUTTONx);
+
 /*
  * Function: BUTTON_IsPressed
  * ----------------------------
@@ -0,0 +1,157 @@
+/******************************************************************************
+ *
+ * Module: CURRENT SENSE
+ *
+ * File Name: current_sense.h
+ *
+ * Description: Header file for the motor current sense driver and anti-pinch detector
+ *              (timer-triggered ADC, circular DMA into a ping-pong buffer).
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#ifndef CURRENT_SENSE_H_
+#define CURRENT_SENSE_H_
+
+#include "stm32f429xx.h"     // Include necessary STM32F4xx headers
+#include "stm32f4xx_hal.h"   // Include necessary STM32F4xx HAL headers
+#include <stdint.h>          // Include standard integer types
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Shunt amplifier output on PA5 (ADC12_IN5) */
+#define CURRENT_SENSE_ADC             ADC1
+#define CURRENT_SENSE_ADC_CHANNEL     (5U)
+#define CURRENT_SENSE_GPIO_PORT       GPIOA
+#define CURRENT_SENSE_PIN_ID          GPIO_PIN_5
+
+/* Sampling: TIM3 update (TRGO) starts one conversion */
+#define CURRENT_SENSE_TIMER           TIM3
+#define CURRENT_SENSE_SAMPLE_RATE_HZ  (20000U)
+
+/* ADC1 requests on DMA2 Stream0 channel 0 */
+#define CURRENT_SENSE_DMA_STREAM      DMA2_Stream0
+#define CURRENT_SENSE_DMA_CHANNEL     DMA_CHANNEL_0
+#define CURRENT_SENSE_DMA_IRQn        DMA2_Stream0_IRQn
+
+/* One half of the ping-pong buffer: 32 samples = 1.6 ms at 20 kHz */
+#define CURRENT_SENSE_BLOCK_SHIFT     (5U)
+#define CURRENT_SENSE_BLOCK_SIZE      (1U << CURRENT_SENSE_BLOCK_SHIFT)
+
+/* A pinch is reported at most this many samples after it starts (the detector works
+ * on block means: a step in the middle of a block is certain to show in the next one) */
+#define CURRENT_SENSE_MAX_DETECTION_SAMPLES  (2U * CURRENT_SENSE_BLOCK_SIZE)
+
+#define __CURRENT_SENSE_ADC_CLK_ENABLE()     __HAL_RCC_ADC1_CLK_ENABLE()
+#define __CURRENT_SENSE_TIMER_CLK_ENABLE()   __HAL_RCC_TIM3_CLK_ENABLE()
+#define __CURRENT_SENSE_DMA_CLK_ENABLE()     __HAL_RCC_DMA2_CLK_ENABLE()
+#define __CURRENT_SENSE_PORT_CLK_ENABLE()    __HAL_RCC_GPIOA_CLK_ENABLE()
+
+typedef struct
+{
+    uint16_t threshold;        // Block mean (ADC counts) reported as a pinch, until CurrentSense_SetThreshold()
+    uint16_t slope;            // Rise of the block mean from one block to the next reported as a pinch
+    uint16_t blankingBlocks;   // Blocks ignored after arming (motor inrush current)
+    uint16_t settleBlocks;     // Blocks ignored after a speed increase of the running motor
+} CurrentSense_ConfigTypeDef;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Configure the ADC, its trigger timer and the circular DMA, and start sampling.
+ * The detector starts disarmed.
+ *
+ * Parameters:
+ * - config: Pointer to the detector thresholds (kept by reference).
+ *
+ * Return:
+ * - None
+ */
+void CurrentSense_Init(const CurrentSense_ConfigTypeDef *config);
+
+/*
+ * Description :
+ * Arm the pinch detector (motor started). The first config->blankingBlocks
+ * blocks are ignored.
+ */
+void CurrentSense_Arm(void);
+
+/*
+ * Description :
+ * Speed increase of the running motor: ignore the next config->settleBlocks blocks
+ * while the current follows the new duty cycle. Never shortens the inrush blanking,
+ * no effect on a disarmed detector.
+ */
+void CurrentSense_Settle(void);
+
+/*
+ * Description :
+ * Disarm the pinch detector (motor stopped).
+ */
+void CurrentSense_Disarm(void);
+
+/*
+ * Description :
+ * Return 1 while the detector is armed and past its blanking blocks.
+ */
+uint8_t CurrentSense_IsMonitoring(void);
+
+/*
+ * Description :
+ * Replace the pinch threshold (e.g. with a per-position threshold), used from the next block on.
+ *
+ * Parameters:
+ * - threshold: Block mean (ADC counts) reported as a pinch.
+ *
+ * Return:
+ * - None
+ */
+void CurrentSense_SetThreshold(uint16_t threshold);
+
+/*
+ * Description :
+ * Return the mean of the last block of samples, in ADC counts.
+ */
+uint16_t CurrentSense_GetLevel(void);
+
+/*
+ * Description :
+ * Pinch notification, called from the DMA interrupt at the end of the block where the
+ * pinch was detected. The detector disarms itself before the call.
+ * Weak: override it in the application to stop the motor.
+ *
+ * Parameters:
+ * - level: Block mean that triggered the detection, in ADC counts.
+ *
+ * Return:
+ * - None
+ */
+void CurrentSense_PinchCallback(uint16_t level);
+
+/*
+ * Description :
+ * Block notification, called from the DMA interrupt for every complete block of
+ * CURRENT_SENSE_BLOCK_SIZE samples (the DMA is filling the other half meanwhile).
+ * Weak: override it in the application to run more signal processing.
+ *
+ * Parameters:
+ * - block: First sample of the block.
+ *
+ * Return:
+ * - None
+ */
+void CurrentSense_BlockCallback(const volatile uint16_t *block);
+
+/*
+ * Description :
+ * DMA interrupt service, called from the CURRENT_SENSE_DMA_IRQn handler.
+ */
+void CurrentSense_IRQHandler(void);
+
+#endif /* CURRENT_SENSE_H_ */
@@ -0,0 +1,60 @@
+/******************************************************************************
+ *
+ * Module: CYCLE COUNTER
+ *
+ * File Name: cycle_counter.h
+ *
+ * Description: Header file for the DWT cycle counter used for latency measurements.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#ifndef CYCLE_COUNTER_H_
+#define CYCLE_COUNTER_H_
+
+#include "stm32f429xx.h"     // Include necessary STM32F4xx headers
+#include "stm32f4xx_hal.h"   // Include necessary STM32F4xx HAL headers
+#include <stdint.h>          // Include standard integer types
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Enable the DWT cycle counter (CYCCNT) and reset it to zero.
+ *
+ * Must be called once before any timestamp is taken, normally from main() right
+ * after SystemClock_Config() so that SystemCoreClock holds the final core frequency.
+ *
+ * Return:
+ * - None
+ */
+void CycleCounter_Init(void);
+
+/*
+ * Description :
+ * Convert a number of core clock cycles to microseconds using SystemCoreClock.
+ *
+ * Parameters:
+ * - cycles: Elapsed cycles (difference of two CycleCounter_Get() timestamps).
+ *
+ * Return:
+ * - uint32_t: The elapsed time in microseconds.
+ */
+uint32_t CycleCounter_ToMicroseconds(uint32_t cycles);
+
+/*
+ * Description :
+ * Return the current value of the free-running 32-bit cycle counter.
+ *
+ * Safe to call from both task and interrupt context. Differences between two
+ * timestamps are correct across a single wrap-around (unsigned arithmetic).
+ */
+static inline uint32_t CycleCounter_Get(void)
+{
+    return DWT->CYCCNT;
+}
+
+#endif /* CYCLE_COUNTER_H_ */
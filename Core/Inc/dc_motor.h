@@ -15,6 +15,7 @@
 #include "stm32f429xx.h"
 #include "stm32f4xx_hal.h"
 #include "stdint.h"
+#include "cycle_counter.h"
 
 /*******************************************************************************
  *                                Definitions                                  *
@@ -22,17 +23,47 @@
 
 #define MOTOR_IN1_PIN_ID           GPIO_PIN_0
 #define MOTOR_IN2_PIN_ID           GPIO_PIN_1
-#define MOTOR_EN1_PIN_ID           GPIO_PIN_2
+#define MOTOR_EN1_PIN_ID           GPIO_PIN_6      /* TIM4_CH1: PB2 has no timer output */
+#define MOTOR_EN1_PIN_AF           GPIO_AF2_TIM4
 #define MOTOR_GPIO_PORT            GPIOB
 
-#define __MOTOR_PORT_CLK_ENABLE()   __HAL_RCC_GPIOB_CLK_ENABLE()
+/* EN1 PWM: the duty cycle sets the motor speed */
+#define MOTOR_PWM_TIMER            TIM4
+#define MOTOR_PWM_CHANNEL          TIM_CHANNEL_1
+#define MOTOR_PWM_COMPARE_REG      (MOTOR_PWM_TIMER->CCR1)
+#define MOTOR_PWM_FREQUENCY_HZ     (20000U)
 
+/* Speed ramps: every MOTOR_RAMP_STEP_US the ramp timer update event makes the DMA
+ * copy the next compare value of a precomputed ramp table into MOTOR_PWM_COMPARE_REG */
+#define MOTOR_RAMP_TIMER           TIM6
+#define MOTOR_RAMP_DMA_STREAM      DMA1_Stream1    /* TIM6_UP request */
+#define MOTOR_RAMP_DMA_CHANNEL     DMA_CHANNEL_7
+#define MOTOR_RAMP_DMA_IRQn        DMA1_Stream1_IRQn
+#define MOTOR_RAMP_STEP_US         (2000U)
+#define MOTOR_RAMP_MAX_STEPS       (250U)          /* Longest ramp: 250 * 2 ms = 500 ms */
 
-/* Enum DcMotor_State to Select type of motion of DC-Motor (CW, A_CW, Stop) */
+/* Both IN pins low between the two directions of a reversal */
+#define MOTOR_DEAD_TIME_US         (5U)
+
+#define MOTOR_DEFAULT_SPEED        (100U)          /* Duty cycle in percent */
+#define MOTOR_DEFAULT_ACCEL_MS     (300U)          /* 0 -> 100 % */
+#define MOTOR_DEFAULT_DECEL_MS     (200U)          /* 100 -> 0 % */
+
+#define __MOTOR_PORT_CLK_ENABLE()         __HAL_RCC_GPIOB_CLK_ENABLE()
+#define __MOTOR_PWM_TIMER_CLK_ENABLE()    __HAL_RCC_TIM4_CLK_ENABLE()
+#define __MOTOR_RAMP_TIMER_CLK_ENABLE()   __HAL_RCC_TIM6_CLK_ENABLE()
+#define __MOTOR_RAMP_DMA_CLK_ENABLE()     __HAL_RCC_DMA1_CLK_ENABLE()
+
+
+/* Enum DcMotor_State to Select type of motion of DC-Motor (CW, A_CW, Stop, Brake)
+ * STOP/COAST: IN1 = IN2 = 0 and EN1 off, the motor runs down freely.
+ * BRAKE:      IN1 = IN2 = 1 and EN1 fully on, the motor terminals are shorted. */
 typedef enum {
-	STOP, Anti_ClockWise, ClockWise
+	STOP, Anti_ClockWise, ClockWise, BRAKE, COAST = STOP
 } DcMotor_State;
 
+#define DCMOTOR_NUM_STATES         (BRAKE + 1U)
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
@@ -40,22 +71,101 @@ typedef enum {
 /*
  Description
  1) The Function responsible for setup the direction for the two motor pins through the GPIO driver.
- 2) Stop at the DC-Motor at the beginning through the GPIO driver.
+ 2) Setup the EN1 PWM timer and the DMA driven speed ramp.
+ 3) Stop at the DC-Motor at the beginning through the GPIO driver.
  */
 void DcMotor_Init(void);
 
 /*
  Description:
- 1) The function responsible for rotate the DC Motor CW/ or A-CW or stop the motor based on the state input state value.
+ 1) The function responsible for rotate the DC Motor CW/ or A-CW, stop or brake the motor based on the state input state value.
+    Every transition is a single BSRR write of both IN pins, a reversal goes through
+    STOP for MOTOR_DEAD_TIME_US first.
 
- 2) Send the required duty cycle to the PWM driver based on the required speed value.
+ 2) CW/A-CW soft-start: the duty cycle ramps from its current value up to the speed set by DcMotor_SetSpeed().
+    STOP is immediate (used for limit switches and jams), see DcMotor_Stop() for a soft stop.
 
  Inputs:
- 1) State: The required DC Motor state, it should be CW or A-CW or stop.
+ 1) State: The required DC Motor state, it should be CW or A-CW or stop (coast) or brake.
  DcMotor_State data type should be declared as enum or uint8.
 
  Return: None
  */
 void DcMotor_Rotate(DcMotor_State state);
 
+/*
+ Description:
+ Cut the H-bridge (IN1 = IN2 = 0) with a single BSRR write, for the jam interrupts.
+ Only the outputs change: DcMotor_Rotate(STOP) must follow to update the driver state.
+ Safe from any context (atomic, idempotent).
+
+ Return: None
+ */
+static inline void DcMotor_Cut(void) {
+	MOTOR_GPIO_PORT->BSRR = ((uint32_t)(MOTOR_IN1_PIN_ID | MOTOR_IN2_PIN_ID) << 16U);
+}
+
+/*
+ Description:
+ Soft stop: ramp the duty cycle down to zero with the deceleration ramp, then stop the motor.
+
+ Return: None
+ */
+void DcMotor_Stop(void);
+
+/*
+ Description:
+ Set the motor speed. If the motor is running, the duty cycle ramps to the new value.
+
+ Inputs:
+ 1) duty: Duty cycle of EN1 in percent (0 - 100).
+
+ Return: None
+ */
+void DcMotor_SetSpeed(uint8_t duty);
+
+/*
+ Description:
+ Configure the soft-start / soft-stop ramps.
+
+ Inputs:
+ 1) accelerationMs: Time of a 0 -> 100 % duty cycle ramp (0 = no ramp).
+ 2) decelerationMs: Time of a 100 -> 0 % duty cycle ramp (0 = no ramp).
+
+ Return: None
+ */
+void DcMotor_SetRamp(uint16_t accelerationMs, uint16_t decelerationMs);
+
+/*
+ Description:
+ Return the direction the motor is currently driven in (a motor still decelerating
+ after DcMotor_Stop() keeps its direction until the ramp ends).
+ */
+DcMotor_State DcMotor_GetState(void);
+
+/*
+ Description:
+ Cost of the last transition into a state, in CPU cycles, from the DcMotor_Rotate() call to
+ the H-bridge output write (including the dead-time of a reversal).
+ */
+uint32_t DcMotor_GetTransitionCycles(DcMotor_State state);
+
+/*
+ Description:
+ State change notification, called from DcMotor_Rotate(), DcMotor_SetSpeed() (running motor)
+ and from the ramp DMA interrupt (end of a soft stop). Weak: override it in the application
+ to follow the motor motion.
+
+ Inputs:
+ 1) state: New motor state.
+ 2) speed: Speed set point in percent.
+ */
+void DcMotor_StateCallback(DcMotor_State state, uint8_t speed);
+
+/*
+ Description:
+ Ramp DMA interrupt service, called from the MOTOR_RAMP_DMA_IRQn handler at the end of a ramp.
+ */
+void DcMotor_RampIRQHandler(void);
+
 #endif /* DC_MOTOR_H_ */
@@ -0,0 +1,180 @@
+/******************************************************************************
+ *
+ * Module: DEBOUNCE
+ *
+ * File Name: debounce.h
+ *
+ * Description: Header file for the bit-parallel (vertical counter) input debouncer.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#ifndef DEBOUNCE_H_
+#define DEBOUNCE_H_
+
+#include "stm32f429xx.h"     // Include necessary STM32F4xx headers
+#include "stm32f4xx_hal.h"   // Include necessary STM32F4xx HAL headers
+#include <stdint.h>          // Include standard integer types
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Input sampling:
+ * DEBOUNCE_SAMPLING_TIMER_IRQ: the debounce timer interrupt reads the ports, started by the
+ *                              button EXTI edges and stopped once every pin has settled.
+ * DEBOUNCE_SAMPLING_DMA:       DEBOUNCE_DMA_TIMER requests copy GPIOB->IDR / GPIOD->IDR into a
+ *                              circular buffer at DEBOUNCE_DMA_RATE_HZ with no CPU involvement;
+ *                              the half/full-transfer interrupts process whole blocks. */
+#define DEBOUNCE_SAMPLING_TIMER_IRQ    (0)
+#define DEBOUNCE_SAMPLING_DMA          (1)
+#define DEBOUNCE_SAMPLING              DEBOUNCE_SAMPLING_DMA
+
+#define DEBOUNCE_TIMER                 TIM7
+#define DEBOUNCE_TIMER_IRQn            TIM7_IRQn
+
+/* Sampling period of the debounce timer. A pin must read the same level on
+ * DEBOUNCE_SAMPLES_NUM consecutive samples before its debounced state changes.
+ * With DMA sampling this is the block period: a pin counts as a differing sample
+ * only if every raw sample of the block differs. */
+#define DEBOUNCE_SAMPLE_PERIOD_US      (5000U)
+#define DEBOUNCE_SAMPLES_NUM           (4U)     // Fixed by the 2-bit vertical counter
+
+/* DMA sampling: the update event samples GPIOB, the compare 1 event (half a period
+ * later) samples GPIOD. DMA2 is the only controller that reaches the AHB1 GPIO ports. */
+#define DEBOUNCE_DMA_TIMER             TIM8
+#define DEBOUNCE_DMA_RATE_HZ           (2000U)
+#define DEBOUNCE_DMA_PORTB_STREAM      DMA2_Stream1    /* TIM8_UP request */
+#define DEBOUNCE_DMA_PORTB_CHANNEL     DMA_CHANNEL_7
+#define DEBOUNCE_DMA_PORTD_STREAM      DMA2_Stream2    /* TIM8_CH1 request */
+#define DEBOUNCE_DMA_PORTD_CHANNEL     DMA_CHANNEL_7
+#define DEBOUNCE_DMA_IRQn              DMA2_Stream2_IRQn
+#define DEBOUNCE_DMA_BLOCK_SAMPLES     ((DEBOUNCE_DMA_RATE_HZ * (DEBOUNCE_SAMPLE_PERIOD_US / 1000U)) / 1000U)
+
+#define __DEBOUNCE_DMA_TIMER_CLK_ENABLE()   __HAL_RCC_TIM8_CLK_ENABLE()
+#define __DEBOUNCE_DMA_CLK_ENABLE()         __HAL_RCC_DMA2_CLK_ENABLE()
+
+/*
+ * All debounced inputs are packed in one 32-bit word:
+ * bits 0..15 are GPIOB pins, bits 16..31 are GPIOD pins.
+ * A set bit always means "pressed" (pin pulled low).
+ */
+#define DEBOUNCE_PORTB_SHIFT           (0U)
+#define DEBOUNCE_PORTD_SHIFT           (16U)
+
+#define DEBOUNCE_MASK(GPIOx, pin)      (((GPIOx) == GPIOD)? ((uint32_t)(pin) << DEBOUNCE_PORTD_SHIFT) \
+                                                          : ((uint32_t)(pin) << DEBOUNCE_PORTB_SHIFT))
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize the debounce service.
+ *
+ * Configures the debounce timer, latches the current level of every tracked pin as
+ * its stable state (so no edges are reported at start-up) and leaves the timer stopped.
+ * With DMA sampling, the sampling timer and the DMA streams run from here on.
+ *
+ * Parameters:
+ * - pinMask: DEBOUNCE_MASK() of every pin that has to be debounced.
+ *
+ * Preconditions:
+ * - The pins must already be configured as inputs with pull-up (see BUTTON_Init()).
+ *
+ * Return:
+ * - None
+ */
+void Debounce_Init(uint32_t pinMask);
+
+/*
+ * Description :
+ * Start sampling (if not already running).
+ *
+ * Meant to be called from the EXTI interrupt of any tracked pin. The timer stops
+ * itself once every tracked pin has settled, so the service costs nothing while idle.
+ * With DMA sampling the sampling never stops: only reports whether the pins were settled.
+ *
+ * Return:
+ * - uint8_t: 1 if this call started a new sampling burst, 0 if it was already running.
+ */
+uint8_t Debounce_Start(void);
+
+/*
+ * Description :
+ * Timer interrupt service of the debounce service, called from DEBOUNCE_TIMER's IRQ handler.
+ *
+ * Reads GPIOB->IDR and GPIOD->IDR once and advances the vertical counters of every
+ * tracked pin in parallel.
+ *
+ * Return:
+ * - None
+ */
+void Debounce_IRQHandler(void);
+
+/*
+ * Description :
+ * DMA interrupt service of the debounce service (DMA sampling), called from the
+ * DEBOUNCE_DMA_IRQn handler. Each half/full transfer hands over one block of
+ * DEBOUNCE_DMA_BLOCK_SAMPLES samples of both ports.
+ *
+ * Return:
+ * - None
+ */
+void Debounce_DmaIRQHandler(void);
+
+/*
+ * Description :
+ * Cost of the last block processing (DMA sampling) in CPU cycles.
+ */
+uint32_t Debounce_GetBlockCycles(void);
+
+/*
+ * Description :
+ * Return the debounced state of all tracked pins (set bit = pressed).
+ */
+uint32_t Debounce_GetState(void);
+
+/*
+ * Description :
+ * Return and clear the edges accumulated since the previous call.
+ *
+ * Parameters:
+ * - pressed: Receives the mask of pins that became pressed (may be NULL).
+ * - released: Receives the mask of pins that became released (may be NULL).
+ *
+ * Return:
+ * - None
+ */
+void Debounce_GetEdges(uint32_t *pressed, uint32_t *released);
+
+/*
+ * Description :
+ * Check the debounced state of a single pin.
+ *
+ * Parameters:
+ * - GPIOx: GPIOB or GPIOD.
+ * - pin: GPIO_PIN_x of the input.
+ *
+ * Return:
+ * - uint8_t: 1 if the pin is (debounced) pressed, 0 otherwise.
+ */
+uint8_t Debounce_IsPressed(GPIO_TypeDef *GPIOx, uint16_t pin);
+
+/*
+ * Description :
+ * Edge notification, called from the timer interrupt whenever at least one debounced
+ * state changed. Weak: override it in the application to wake the consumers.
+ *
+ * Parameters:
+ * - pressed: Mask of pins that became pressed on this sample.
+ * - released: Mask of pins that became released on this sample.
+ *
+ * Return:
+ * - None
+ */
+void Debounce_EdgeCallback(uint32_t pressed, uint32_t released);
+
+#endif /* DEBOUNCE_H_ */
@@ -0,0 +1,78 @@
+/******************************************************************************
+ *
+ * Module: ENCODER
+ *
+ * File Name: encoder.h
+ *
+ * Description: Header file for the quadrature encoder driver (timer encoder interface,
+ *              the position is counted in hardware without any per-edge interrupt).
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#ifndef ENCODER_H_
+#define ENCODER_H_
+
+#include "stm32f429xx.h"     // Include necessary STM32F4xx headers
+#include "stm32f4xx_hal.h"   // Include necessary STM32F4xx HAL headers
+#include <stdint.h>          // Include standard integer types
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* TIM2 is a 32-bit timer: the count never wraps over a window travel.
+ *
+ * Pin conflict: PA15 and PB3 are the JTDI and JTDO/TRACESWO debug pins after reset.
+ * Encoder_Init() muxes them to TIM2, which disables the JTAG port and the SWO trace
+ * output (ITM printf, SWV data trace) for the rest of the run; SWD debugging on
+ * PA13/PA14 keeps working. Build without PWC_POSITION_ENCODER when SWO is needed,
+ * or wire the encoder to the other TIM2 pair (PA0/PA1, AF1) instead. */
+#define ENCODER_TIMER                 TIM2
+#define ENCODER_A_GPIO_PORT           GPIOA
+#define ENCODER_A_PIN_ID              GPIO_PIN_15     /* TIM2_CH1 */
+#define ENCODER_B_GPIO_PORT           GPIOB
+#define ENCODER_B_PIN_ID              GPIO_PIN_3      /* TIM2_CH2 */
+#define ENCODER_PIN_AF                GPIO_AF1_TIM2
+#define ENCODER_INPUT_FILTER          (6U)            /* Input capture digital filter (0 - 15) */
+
+#define __ENCODER_TIMER_CLK_ENABLE()  __HAL_RCC_TIM2_CLK_ENABLE()
+#define __ENCODER_PORT_CLK_ENABLE()   do { __HAL_RCC_GPIOA_CLK_ENABLE(); __HAL_RCC_GPIOB_CLK_ENABLE(); } while (0)
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Configure the encoder pins and the timer in encoder mode (x4, both channels), and
+ * start counting from zero.
+ *
+ * Return:
+ * - None
+ */
+void Encoder_Init(void);
+
+/*
+ * Description :
+ * Overwrite the hardware count (e.g. zero it on a reference switch).
+ *
+ * Parameters:
+ * - count: New count.
+ *
+ * Return:
+ * - None
+ */
+void Encoder_SetCount(int32_t count);
+
+/*
+ * Description :
+ * Return the hardware count (signed: counting down from zero gives negative values).
+ */
+static inline int32_t Encoder_GetCount(void)
+{
+    return (int32_t)ENCODER_TIMER->CNT;
+}
+
+#endif /* ENCODER_H_ */
@@ -0,0 +1,113 @@
+/******************************************************************************
+ *
+ * Module: EVENT RING
+ *
+ * File Name: event_ring.h
+ *
+ * Description: Header file for the lock-free single-producer / single-consumer
+ *              ring of timestamped input events.
+ *
+ *   The producer (one interrupt vector) only writes the head, the consumer (one
+ *   task) only writes the tail: neither side needs a critical section or a
+ *   kernel call. A full ring drops the new event and counts it.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#ifndef EVENT_RING_H_
+#define EVENT_RING_H_
+
+#include "stm32f429xx.h"     // Include necessary STM32F4xx headers
+#include "stm32f4xx_hal.h"   // Include necessary STM32F4xx HAL headers
+#include <stdint.h>          // Include standard integer types
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+typedef struct
+{
+    uint32_t timestamp;     // CycleCounter_Get() when the interrupt was entered
+    uint8_t source;         // Input identifier (EXTI line)
+    uint8_t level;          // Pin level after the edge
+    uint16_t reserved;
+} EventRing_EventTypeDef;
+
+typedef struct
+{
+    EventRing_EventTypeDef *buffer;
+    uint32_t mask;                  // Size - 1, the size is a power of two
+    volatile uint32_t head;         // Written by the producer only (free-running)
+    volatile uint32_t tail;         // Written by the consumer only (free-running)
+    volatile uint32_t dropped;      // Events lost on a full ring (producer side)
+} EventRing_TypeDef;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize an empty ring on its storage.
+ *
+ * Parameters:
+ * - ring: Pointer to the ring instance.
+ * - buffer: Event storage.
+ * - size: Number of events of the storage, a power of two.
+ *
+ * Return:
+ * - None
+ */
+void EventRing_Init(EventRing_TypeDef *ring, EventRing_EventTypeDef *buffer, uint32_t size);
+
+/*
+ * Description :
+ * Producer side: append one event (interrupt context, never blocks).
+ *
+ * Return:
+ * - uint8_t: 1 if stored, 0 if the ring was full (counted in dropped).
+ */
+static inline uint8_t EventRing_Push(EventRing_TypeDef *ring, uint32_t timestamp, uint8_t source, uint8_t level)
+{
+    uint32_t head = ring->head;
+    EventRing_EventTypeDef *event;
+
+    /* Unsigned difference of the free-running indexes: number of unread events */
+    if ((head - ring->tail) > ring->mask)
+    {
+        ring->dropped++;
+        return 0;
+    }
+
+    event = &ring->buffer[head & ring->mask];
+    event->timestamp = timestamp;
+    event->source = source;
+    event->level = level;
+
+    /* The event must be complete in memory before the consumer can see the new head */
+    __DMB();
+    ring->head = head + 1U;
+
+    return 1;
+}
+
+/*
+ * Description :
+ * Consumer side: oldest unread event, left in the ring.
+ *
+ * Return:
+ * - const EventRing_EventTypeDef *: NULL if the ring is empty.
+ */
+const EventRing_EventTypeDef *EventRing_Peek(EventRing_TypeDef *ring);
+
+/*
+ * Description :
+ * Consumer side: release the event returned by EventRing_Peek().
+ *
+ * Return:
+ * - None
+ */
+void EventRing_Pop(EventRing_TypeDef *ring);
+
+#endif /* EVENT_RING_H_ */
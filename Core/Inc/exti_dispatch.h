@@ -0,0 +1,100 @@
+/******************************************************************************
+ *
+ * Module: EXTI DISPATCH
+ *
+ * File Name: exti_dispatch.h
+ *
+ * Description: Header file for the EXTI dispatcher: one const handler table indexed
+ *              by EXTI line (0 - 15), shared by all the EXTI interrupt vectors, and a
+ *              timestamped log of every edge.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#ifndef EXTI_DISPATCH_H_
+#define EXTI_DISPATCH_H_
+
+#include "stm32f4xx_hal.h"
+#include "event_ring.h"
+#include <stdint.h>          // Include standard integer types
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define EXTI_DISPATCH_NUM_LINES       (16U)     /* GPIO lines: EXTIn is pin n of the selected port */
+
+#define EXTI_DISPATCH_LINE(line)      (1UL << (line))
+
+/* Edge log: one SPSC ring per vector (a vector never preempts itself: single producer) */
+#define EXTI_DISPATCH_LOG_SIZE        (32U)     /* Events per vector, power of two */
+
+/* EXTI interrupt vectors */
+typedef enum
+{
+    EXTI_DISPATCH_VECTOR_0, EXTI_DISPATCH_VECTOR_1, EXTI_DISPATCH_VECTOR_2, EXTI_DISPATCH_VECTOR_3,
+    EXTI_DISPATCH_VECTOR_4, EXTI_DISPATCH_VECTOR_9_5, EXTI_DISPATCH_VECTOR_15_10, EXTI_DISPATCH_NUM_VECTORS
+} ExtiDispatch_Vector_e;
+
+/* Line handler (interrupt context), called with the context of its table entry */
+typedef void (*ExtiDispatch_Handler)(void *context);
+
+typedef struct
+{
+    ExtiDispatch_Handler handler;   // NULL: the line is cleared and ignored
+    void *context;                  // Instance the handler works on (button, limit switch...)
+} ExtiDispatch_EntryTypeDef;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Register the handler table, before the EXTI interrupts are enabled.
+ *
+ * Parameters:
+ * - table: EXTI_DISPATCH_NUM_LINES entries indexed by line, kept by reference
+ *          (declare it const so it stays in flash).
+ *
+ * Return:
+ * - None
+ */
+void ExtiDispatch_Register(const ExtiDispatch_EntryTypeDef *table);
+
+/*
+ * Description :
+ * EXTI interrupt service, called from every EXTI vector. Clears its pending lines once,
+ * logs an edge event (entry timestamp, line, pin level) for each of them, then calls
+ * their handler, highest line first. No critical section and no kernel call.
+ *
+ * Parameters:
+ * - vector: The calling vector.
+ *
+ * Return:
+ * - None
+ */
+void ExtiDispatch_IRQHandler(ExtiDispatch_Vector_e vector);
+
+/*
+ * Description :
+ * Consumer side of the edge log, from a single task: move up to maxEvents logged edges
+ * into events, oldest first across all the vectors (merged by timestamp).
+ *
+ * Parameters:
+ * - events: Destination of the batch.
+ * - maxEvents: Batch size.
+ *
+ * Return:
+ * - uint32_t: Number of events returned (0: the log is empty).
+ */
+uint32_t ExtiDispatch_ReadEvents(EventRing_EventTypeDef *events, uint32_t maxEvents);
+
+/*
+ * Description :
+ * Return the number of edges lost on a full log since the registration.
+ */
+uint32_t ExtiDispatch_GetDroppedEvents(void);
+
+#endif /* EXTI_DISPATCH_H_ */
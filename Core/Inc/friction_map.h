@@ -0,0 +1,112 @@
+/******************************************************************************
+ *
+ * Module: FRICTION MAP
+ *
+ * File Name: friction_map.h
+ *
+ * Description: Header file for the learned per-position friction (motor current)
+ *              profile that sets the anti-pinch threshold along the travel.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#ifndef FRICTION_MAP_H_
+#define FRICTION_MAP_H_
+
+#include "stm32f429xx.h"     // Include necessary STM32F4xx headers
+#include "stm32f4xx_hal.h"   // Include necessary STM32F4xx HAL headers
+#include <stdint.h>          // Include standard integer types
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* One bin per 1/256 of the travel (positions 0 .. 1000 in 0.1 %) */
+#define FRICTION_MAP_BINS            (256U)
+
+/* Persistent copy: last sector of bank 2 (128 KB), so the erase does not stall
+ * the code running from bank 1 */
+#define FRICTION_MAP_FLASH_SECTOR    FLASH_SECTOR_23
+#define FRICTION_MAP_FLASH_ADDRESS   (0x081E0000UL)
+
+typedef struct
+{
+    uint16_t defaultThreshold;  // Pinch threshold of a bin not learned yet, in ADC counts
+    uint16_t margin;            // Pinch threshold above the learned current of a bin, in ADC counts
+    uint8_t learnShift;         // Profile EMA: profile += (run peak - profile) >> learnShift
+    uint8_t minimumRuns;        // Clean closes through a bin before its learned threshold is used
+    uint32_t saveIntervalMs;    // Minimum time between two flash writes
+} FrictionMap_ConfigTypeDef;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize the map from its flash copy (or empty if there is no valid copy)
+ * and build the threshold lookup table.
+ *
+ * Parameters:
+ * - config: Pointer to the map settings (kept by reference).
+ *
+ * Return:
+ * - None
+ */
+void FrictionMap_Init(const FrictionMap_ConfigTypeDef *config);
+
+/*
+ * Description :
+ * Return the pinch threshold at a position, one table lookup (interrupt safe).
+ *
+ * Parameters:
+ * - position: Window position in 0.1 % (0 .. 1000).
+ *
+ * Return:
+ * - uint16_t: Threshold in ADC counts.
+ */
+uint16_t FrictionMap_GetThreshold(uint16_t position);
+
+/*
+ * Description :
+ * Start recording a closing run (no effect while a run is already recorded
+ * or the previous one is not merged yet).
+ */
+void FrictionMap_StartRun(void);
+
+/*
+ * Description :
+ * Record the motor current of one block of the closing run (interrupt context).
+ *
+ * Parameters:
+ * - position: Window position in 0.1 % (0 .. 1000).
+ * - level: Block mean of the motor current, in ADC counts.
+ *
+ * Return:
+ * - None
+ */
+void FrictionMap_RecordLevel(uint16_t position, uint16_t level);
+
+/*
+ * Description :
+ * End the closing run. A clean run (closed up to the limit switch, no pinch)
+ * is merged into the map by FrictionMap_Service(), any other run is dropped.
+ *
+ * Parameters:
+ * - clean: 1 for a clean close.
+ *
+ * Return:
+ * - None
+ */
+void FrictionMap_EndRun(uint8_t clean);
+
+/*
+ * Description :
+ * Housekeeping, called periodically from a low priority task: merges a clean run
+ * into the map and writes the map to flash at most once per config->saveIntervalMs.
+ * The sector erase is polled, never waited for.
+ */
+void FrictionMap_Service(void);
+
+#endif /* FRICTION_MAP_H_ */
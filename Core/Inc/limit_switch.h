@@ -15,15 +15,29 @@
 #include "stm32f429xx.h"     // Include necessary STM32F4xx headers
 #include "stm32f4xx_hal.h"   // Include necessary STM32F4xx HAL headers
 #include <stdint.h>          // Include standard integer types
+#include "FreeRTOS.h"
+#include "task.h"
 
 #define NO_PIN_IS_CONNECTED              (0U)
 #define C_PIN_IS_CONNECTED_TO_GND        (1U)
 
-typedef struct
+/* Task notification bit reserved for LimitSwitch_WaitTouched(). Application
+ * notification bits used by the same task must not overlap it. */
+#define LIMIT_SWITCH_NOTIFY_BIT          (1UL << 31)
+
+typedef struct LimitSwitch_s LimitSwitch_TypeDef;
+
+/* Called from the EXTI interrupt when the limit switch becomes touched */
+typedef void (*LimitSwitch_CallbackTypeDef)(LimitSwitch_TypeDef *limitSwitch);
+
+struct LimitSwitch_s
 {
     GPIO_TypeDef *GPIOx;    // Pointer to the GPIO port of the LimitSwitch
     uint16_t GPIO_pin;      // Pin number of the LimitSwitch
-} LimitSwitch_TypeDef;           // Define LimitSwitch_TypeDef structure for LimitSwitch configuration
+    LimitSwitch_CallbackTypeDef onTouched;  // Optional touch callback (interrupt context)
+    volatile TaskHandle_t waitingTask;      // Task blocked in LimitSwitch_WaitTouched(), if any
+    volatile uint32_t touchTimestamp;       // CYCCNT of the last touch edge
+};                          // LimitSwitch_TypeDef structure for LimitSwitch configuration
 
 typedef enum {
     UNTOUCHED , TOUCHED, UNDEFINED
@@ -87,4 +101,52 @@ uint8_t LimitSwitch_IsPressed(LimitSwitch_TypeDef *limitSwitch);
  */
 LimitSwitchState_e LimitSwitch_GetState(LimitSwitch_TypeDef *limitSwitch);
 
+/*
+ * Description :
+ * Initialize the Limit Switch Pin as an external interrupt source.
+ *
+ * Same pin configuration as LimitSwitch_Init() but routed to its EXTI line on both
+ * edges. The application must enable the matching EXTIx_IRQn in the NVIC and call
+ * LimitSwitch_IRQHandler() from the EXTI handler of this pin.
+ *
+ * Parameters:
+ * - limitSwitch: A pointer to the LimitSwitch structure containing the port and pin information.
+ * - onTouched: Callback invoked from the interrupt at the touch edge (may be NULL).
+ *
+ * Return:
+ * - None
+ */
+void LimitSwitch_InitInterrupt(LimitSwitch_TypeDef *limitSwitch, LimitSwitch_CallbackTypeDef onTouched);
+
+/*
+ * Description :
+ * EXTI service of the limit switch, to be called from the EXTI handler of its pin.
+ *
+ * If the switch is touched, timestamps the edge, runs the touch callback and wakes
+ * the task blocked in LimitSwitch_WaitTouched().
+ *
+ * Parameters:
+ * - limitSwitch: A pointer to the LimitSwitch structure containing the port and pin information.
+ *
+ * Return:
+ * - None
+ */
+void LimitSwitch_IRQHandler(LimitSwitch_TypeDef *limitSwitch);
+
+/*
+ * Description :
+ * Block the calling task until the limit switch is touched or the timeout expires.
+ *
+ * Returns immediately if the switch is already touched. The task sleeps in between,
+ * woken by LimitSwitch_IRQHandler() through LIMIT_SWITCH_NOTIFY_BIT.
+ *
+ * Parameters:
+ * - limitSwitch: A pointer to the LimitSwitch structure (initialized with LimitSwitch_InitInterrupt()).
+ * - timeout: Maximum time to wait, in ticks (portMAX_DELAY to wait forever).
+ *
+ * Return:
+ * - LimitSwitchState_e: TOUCHED if the switch was reached, UNTOUCHED on timeout.
+ */
+LimitSwitchState_e LimitSwitch_WaitTouched(LimitSwitch_TypeDef *limitSwitch, TickType_t timeout);
+
 #endif // LIMIT_SWITCH_H
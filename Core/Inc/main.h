@@ -53,6 +53,7 @@ extern "C" {
 void Error_Handler(void);
 
 /* USER CODE BEGIN EFP */
+uint16_t PWC_GetPosition(void);
 
 /* USER CODE END EFP */
 
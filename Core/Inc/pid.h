@@ -0,0 +1,80 @@
+/******************************************************************************
+ *
+ * Module: PID
+ *
+ * File Name: pid.h
+ *
+ * Description: Header file for the fixed-point PID controller.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#ifndef PID_H_
+#define PID_H_
+
+#include <stdint.h>          // Include standard integer types
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define PID_GAIN_SHIFT       (8U)
+#define PID_GAIN_ONE         (1L << PID_GAIN_SHIFT)   // Gains are Q8: PID_GAIN_ONE = 1.0
+#define PID_ERROR_LIMIT      (1L << 20)               // Errors are clamped to +/- PID_ERROR_LIMIT (gains below 2048)
+
+typedef struct
+{
+    int32_t kp;          // Proportional gain (Q8)
+    int32_t ki;          // Integral gain per loop period (Q8)
+    int32_t kd;          // Derivative gain per loop period (Q8)
+    int32_t outputMin;   // Output saturation, also bounds the integral term (anti-windup)
+    int32_t outputMax;
+} Pid_ConfigTypeDef;
+
+typedef struct
+{
+    const Pid_ConfigTypeDef *config;
+    int32_t integral;        // Integral term (Q8)
+    int32_t previousError;
+    uint8_t first;           // No previous error yet (no derivative kick)
+} Pid_TypeDef;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize a controller. The loop must run at a fixed rate: the integral and
+ * derivative gains are per loop period.
+ *
+ * Parameters:
+ * - pid: Pointer to the controller instance.
+ * - config: Pointer to the gains and output limits (kept by reference).
+ *
+ * Return:
+ * - None
+ */
+void Pid_Init(Pid_TypeDef *pid, const Pid_ConfigTypeDef *config);
+
+/*
+ * Description :
+ * Clear the integral and derivative history (e.g. at the start of a new move).
+ */
+void Pid_Reset(Pid_TypeDef *pid);
+
+/*
+ * Description :
+ * Run one loop period.
+ *
+ * Parameters:
+ * - pid: Pointer to the controller instance.
+ * - error: Set point minus measurement.
+ *
+ * Return:
+ * - int32_t: Controller output, within [outputMin, outputMax].
+ */
+int32_t Pid_Update(Pid_TypeDef *pid, int32_t error);
+
+#endif /* PID_H_ */
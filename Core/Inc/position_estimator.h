@@ -0,0 +1,125 @@
+/******************************************************************************
+ *
+ * Module: POSITION ESTIMATOR
+ *
+ * File Name: position_estimator.h
+ *
+ * Description: Header file for the sensorless window position estimator
+ *              (dead reckoning of the motor run time, calibrated by the limit switches).
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#ifndef POSITION_ESTIMATOR_H_
+#define POSITION_ESTIMATOR_H_
+
+#include "stm32f429xx.h"     // Include necessary STM32F4xx headers
+#include "stm32f4xx_hal.h"   // Include necessary STM32F4xx HAL headers
+#include <stdint.h>          // Include standard integer types
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define POSITION_FULL_SCALE        (1000000L)   // Internal resolution: 0 = bottom, POSITION_FULL_SCALE = top
+#define POSITION_PERMILLE_DIVIDER  (POSITION_FULL_SCALE / 1000L)
+
+typedef enum {
+    POSITION_STOPPED,      // Motor not driven
+    POSITION_MOVING_UP,    // Motor driven towards the top limit switch
+    POSITION_MOVING_DOWN   // Motor driven towards the bottom limit switch
+} PositionMotion_e;
+
+typedef enum {
+    POSITION_LIMIT_BOTTOM,
+    POSITION_LIMIT_TOP
+} PositionLimit_e;
+
+typedef struct
+{
+    uint32_t travelUpUs;               // Calibrated full travel time bottom -> top, in microseconds
+    uint32_t travelDownUs;             // Calibrated full travel time top -> bottom, in microseconds
+    int32_t position;                  // 0 .. POSITION_FULL_SCALE
+    PositionMotion_e motion;           // Current motion segment
+    uint8_t speed;                     // Speed of the current segment, in percent of the full speed
+    uint32_t motionTimestamp;          // Cycle counter value at the start of the current segment
+    uint8_t referenced;                // A limit switch was touched since power-up
+    uint8_t calibrating;               // Run time since the last limit is still a valid full travel candidate
+    PositionLimit_e calibrationLimit;  // Limit switch the calibration run started from
+    PositionMotion_e calibrationMotion;// Direction of the calibration run (POSITION_STOPPED: not moved yet)
+    uint32_t calibrationUs;            // Full speed equivalent run time accumulated since calibrationLimit
+} PositionEstimator_TypeDef;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize an estimator with default full travel times. The window position is
+ * unknown (reported as mid travel) until the first limit switch is touched.
+ *
+ * Parameters:
+ * - estimator: Pointer to the estimator instance.
+ * - travelUpUs: Default bottom -> top travel time, in microseconds.
+ * - travelDownUs: Default top -> bottom travel time, in microseconds.
+ *
+ * Return:
+ * - None
+ */
+void PositionEstimator_Init(PositionEstimator_TypeDef *estimator, uint32_t travelUpUs, uint32_t travelDownUs);
+
+/*
+ * Description :
+ * Report a change of motor motion or speed. The run time of the segment that just ended
+ * is integrated into the position, scaled by its speed.
+ *
+ * Parameters:
+ * - estimator: Pointer to the estimator instance.
+ * - motion: New motion.
+ * - speed: New speed in percent of the full (calibration) speed.
+ * - timestamp: CycleCounter_Get() value of the change.
+ *
+ * Return:
+ * - None
+ */
+void PositionEstimator_OnMotion(PositionEstimator_TypeDef *estimator, PositionMotion_e motion, uint8_t speed,
+                               uint32_t timestamp);
+
+/*
+ * Description :
+ * Report a touched limit switch. The position is set to the exact end of travel and,
+ * after an uninterrupted one-direction run from the other limit switch, the full
+ * travel time of that direction is recalibrated.
+ *
+ * Parameters:
+ * - estimator: Pointer to the estimator instance.
+ * - limit: Touched limit switch.
+ * - timestamp: CycleCounter_Get() value of the touch.
+ *
+ * Return:
+ * - None
+ */
+void PositionEstimator_OnLimit(PositionEstimator_TypeDef *estimator, PositionLimit_e limit, uint32_t timestamp);
+
+/*
+ * Description :
+ * Return the estimated position, including the running motion segment.
+ *
+ * Parameters:
+ * - estimator: Pointer to the estimator instance.
+ * - timestamp: CycleCounter_Get() value to estimate the position at.
+ *
+ * Return:
+ * - uint16_t: Position in 0.1 % of the full travel (0 = bottom, 1000 = top).
+ */
+uint16_t PositionEstimator_Get(const PositionEstimator_TypeDef *estimator, uint32_t timestamp);
+
+/*
+ * Description :
+ * Return 1 once a limit switch has been touched (the position is then absolute).
+ */
+uint8_t PositionEstimator_IsReferenced(const PositionEstimator_TypeDef *estimator);
+
+#endif /* POSITION_ESTIMATOR_H_ */
@@ -0,0 +1,113 @@
+/******************************************************************************
+ *
+ * Module: PRESS CLASSIFIER
+ *
+ * File Name: press_classifier.h
+ *
+ * Description: Header file for the button press-duration classifier
+ *              (short / long / double press).
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#ifndef PRESS_CLASSIFIER_H_
+#define PRESS_CLASSIFIER_H_
+
+#include "stm32f429xx.h"     // Include necessary STM32F4xx headers
+#include "stm32f4xx_hal.h"   // Include necessary STM32F4xx HAL headers
+#include <stdint.h>          // Include standard integer types
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+typedef enum {
+    PRESS_NONE,      // No complete press yet
+    PRESS_SHORT,     // Released before the long press threshold
+    PRESS_LONG,      // Held at least the long press threshold
+    PRESS_DOUBLE     // Short press that followed another short press within the double press gap
+} PressType_e;
+
+typedef struct
+{
+    uint32_t longPressUs;       // Minimum hold time of a long press, in microseconds
+    uint32_t doublePressGapUs;  // Maximum release-to-press gap of a double press, in microseconds
+} PressClassifier_ConfigTypeDef;  // Thresholds, one set per panel
+
+typedef struct
+{
+    uint32_t longPressCycles;      // Thresholds converted to cycle counter units
+    uint32_t doublePressGapCycles;
+    uint32_t pressTimestamp;       // Cycle counter value of the last press edge
+    uint32_t releaseTimestamp;     // Cycle counter value of the last release edge
+    uint8_t previousShort;         // Last complete press was a short one
+    volatile uint8_t held;         // Last edge was a press
+    volatile PressType_e lastType; // Classification of the last complete press
+} PressClassifier_TypeDef;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize a classifier instance with the thresholds of its panel.
+ *
+ * Parameters:
+ * - classifier: Pointer to the classifier instance.
+ * - config: Pointer to the panel thresholds.
+ *
+ * Preconditions:
+ * - SystemCoreClock must hold the final core frequency (thresholds are converted to cycles).
+ *
+ * Return:
+ * - None
+ */
+void PressClassifier_Init(PressClassifier_TypeDef *classifier, const PressClassifier_ConfigTypeDef *config);
+
+/*
+ * Description :
+ * Feed one (debounced) edge of the button.
+ *
+ * O(1) and safe to call from interrupt context. A press edge only records its
+ * timestamp; a release edge classifies the press that just ended from the edge
+ * timestamps, so the result does not depend on when it is read. A short press
+ * that starts within the gap after the release of a short press is a double
+ * press; a double press does not chain into another one.
+ *
+ * Parameters:
+ * - classifier: Pointer to the classifier instance.
+ * - pressed: 1 for a press edge, 0 for a release edge.
+ * - timestamp: CycleCounter_Get() value of the edge.
+ *
+ * Return:
+ * - PressType_e: PRESS_NONE for a press edge, the classification for a release edge.
+ */
+PressType_e PressClassifier_OnEdge(PressClassifier_TypeDef *classifier, uint8_t pressed, uint32_t timestamp);
+
+/*
+ * Description :
+ * Return the classification of the last complete press (kept while a new press is held).
+ *
+ * Parameters:
+ * - classifier: Pointer to the classifier instance.
+ *
+ * Return:
+ * - PressType_e: PRESS_NONE before the first complete press.
+ */
+PressType_e PressClassifier_GetLast(PressClassifier_TypeDef *classifier);
+
+/*
+ * Description :
+ * Return whether the last edge fed to the classifier was a press.
+ *
+ * Parameters:
+ * - classifier: Pointer to the classifier instance.
+ *
+ * Return:
+ * - uint8_t: 1 while the button is held.
+ */
+uint8_t PressClassifier_IsHeld(PressClassifier_TypeDef *classifier);
+
+#endif /* PRESS_CLASSIFIER_H_ */
@@ -0,0 +1,66 @@
+/******************************************************************************
+ *
+ * Module: RATE GROUP
+ *
+ * File Name: rate_group.h
+ *
+ * Description: Header file for the fixed-rate executive: every rate group is a task
+ *              released at a fixed period by vTaskDelayUntil(), running its jobs in order.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#ifndef RATE_GROUP_H_
+#define RATE_GROUP_H_
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdint.h>          // Include standard integer types
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+typedef void (*RateGroup_Job)(void);
+
+typedef struct
+{
+    const char *name;               // Task name
+    uint16_t periodMs;              // Release period
+    UBaseType_t priority;           // Task priority (higher rate: higher priority)
+    uint16_t stackWords;            // Task stack depth
+    const RateGroup_Job *jobs;      // Jobs run in order at every release
+    uint8_t numJobs;
+} RateGroup_ConfigTypeDef;
+
+typedef struct
+{
+    const RateGroup_ConfigTypeDef *config;
+    TaskHandle_t task;
+    volatile uint32_t activations;      // Releases served
+    volatile uint32_t overruns;         // Releases whose jobs ended after the next release (skipped, not bursted)
+    volatile uint32_t jitterUs;         // |release interval - period| of the last period
+    volatile uint32_t maxJitterUs;
+    volatile uint32_t executionUs;      // Duration of the jobs of the last release
+    volatile uint32_t maxExecutionUs;
+} RateGroup_TypeDef;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Create the task of a rate group, first released one period after the scheduler start.
+ *
+ * Parameters:
+ * - group: Pointer to the rate group instance (statistics).
+ * - config: Pointer to the group declaration (kept by reference).
+ *
+ * Return:
+ * - BaseType_t: pdPASS if the task was created.
+ */
+BaseType_t RateGroup_Create(RateGroup_TypeDef *group, const RateGroup_ConfigTypeDef *config);
+
+#endif /* RATE_GROUP_H_ */
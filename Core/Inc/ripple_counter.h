@@ -0,0 +1,104 @@
+/******************************************************************************
+ *
+ * Module: RIPPLE COUNTER
+ *
+ * File Name: ripple_counter.h
+ *
+ * Description: Header file for the sensorless ripple counter (motor position and speed
+ *              from the commutation ripple of the motor current).
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#ifndef RIPPLE_COUNTER_H_
+#define RIPPLE_COUNTER_H_
+
+#include "stm32f429xx.h"     // Include necessary STM32F4xx headers
+#include "stm32f4xx_hal.h"   // Include necessary STM32F4xx HAL headers
+#include <stdint.h>          // Include standard integer types
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define RIPPLE_COUNTER_TAPS         (16U)    // FIR low-pass length (even: processed in pairs)
+#define RIPPLE_COUNTER_MAX_BLOCK    (64U)    // Largest block accepted by RippleCounter_ProcessBlock()
+#define RIPPLE_COUNTER_DC_SHIFT     (3U)     // DC tracker: EMA of the block means, alpha = 1/8
+
+typedef struct
+{
+    uint32_t sampleRateHz;      // Rate of the samples fed to RippleCounter_ProcessBlock()
+    int16_t hysteresis;         // Filtered ripple amplitude needed to count a peak, in ADC counts
+    uint16_t minimumPeriod;     // Samples between two peaks below which the second one is ignored
+} RippleCounter_ConfigTypeDef;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize the ripple counter (count, filter history and DC tracker cleared).
+ *
+ * Parameters:
+ * - config: Pointer to the detector settings (kept by reference).
+ *
+ * Return:
+ * - None
+ */
+void RippleCounter_Init(const RippleCounter_ConfigTypeDef *config);
+
+/*
+ * Description :
+ * Process one block of raw 12-bit current samples: DC removal, FIR low-pass
+ * (together a band-pass around the commutation ripple) and hysteresis peak
+ * detection. Every peak moves the count by one in the given direction.
+ *
+ * Uses the Cortex-M4 SIMD instructions: __QADD16 removes the DC level of two
+ * samples at once and __SMLAD accumulates two filter taps per instruction.
+ *
+ * Parameters:
+ * - block: Samples (from the current sense DMA buffer).
+ * - size: Number of samples, even and at most RIPPLE_COUNTER_MAX_BLOCK.
+ * - direction: +1 / -1 while the motor is driven up / down, 0 while stopped.
+ *
+ * Return:
+ * - None
+ */
+void RippleCounter_ProcessBlock(const volatile uint16_t *block, uint32_t size, int8_t direction);
+
+/*
+ * Description :
+ * Return the signed ripple count (one count per commutation).
+ */
+int32_t RippleCounter_GetCount(void);
+
+/*
+ * Description :
+ * Overwrite the ripple count (e.g. zero it on a reference switch).
+ */
+void RippleCounter_SetCount(int32_t count);
+
+/*
+ * Description :
+ * Return the ripple frequency measured between the last two peaks, in Hz
+ * (proportional to the motor speed, 0 when no ripple is seen).
+ */
+uint32_t RippleCounter_GetFrequencyHz(void);
+
+/*
+ * Description :
+ * Return the ripple period measured between the last two peaks, in microseconds
+ * (0 when no ripple is seen).
+ */
+uint32_t RippleCounter_GetPeriodUs(void);
+
+/*
+ * Description :
+ * Return the CPU cycles spent on the last block and the worst block.
+ */
+uint32_t RippleCounter_GetProcessCycles(void);
+uint32_t RippleCounter_GetProcessMaxCycles(void);
+
+#endif /* RIPPLE_COUNTER_H_ */
@@ -0,0 +1,71 @@
+/******************************************************************************
+ *
+ * Module: SIGNAL BENCH
+ *
+ * File Name: signal_bench.h
+ *
+ * Description: Header file for the ISR-to-task signalling benchmark: cycles from
+ *              the give in an interrupt to the woken task running, binary
+ *              semaphore versus direct-to-task notification.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#ifndef SIGNAL_BENCH_H_
+#define SIGNAL_BENCH_H_
+
+#include "stm32f4xx_hal.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdint.h>          // Include standard integer types
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Unused EXTI line, triggered in software (no pin edge enabled on it) */
+#define SIGNAL_BENCH_EXTI_LINE     (1UL << 4)
+#define SIGNAL_BENCH_IRQn          EXTI4_IRQn
+
+typedef enum
+{
+    SIGNAL_BENCH_SEMAPHORE, SIGNAL_BENCH_NOTIFICATION, SIGNAL_BENCH_NUM_METHODS
+} SignalBench_Method_e;
+
+typedef struct
+{
+    uint32_t samples;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint32_t averageCycles;
+} SignalBench_ResultTypeDef;
+
+/* Results per method, watch from the debugger */
+extern SignalBench_ResultTypeDef SignalBench_Results[SIGNAL_BENCH_NUM_METHODS];
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Run the benchmark from a task, after the scheduler start. A receiver task is created
+ * at the highest priority for the duration of the run; the calling task triggers
+ * SIGNAL_BENCH_EXTI_LINE, whose handler gives to the blocked receiver.
+ *
+ * Parameters:
+ * - iterations: Signals per method.
+ *
+ * Return:
+ * - BaseType_t: pdPASS if the benchmark ran.
+ */
+BaseType_t SignalBench_Run(uint32_t iterations);
+
+/*
+ * Description :
+ * Benchmark interrupt service, to be dispatched for SIGNAL_BENCH_EXTI_LINE.
+ */
+void SignalBench_IRQHandler(void);
+
+#endif /* SIGNAL_BENCH_H_ */
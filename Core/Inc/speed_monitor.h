@@ -0,0 +1,170 @@
+/******************************************************************************
+ *
+ * Module: SPEED MONITOR
+ *
+ * File Name: speed_monitor.h
+ *
+ * Description: Header file for the speed-drop pinch detector (edge period measured by
+ *              timer input capture, compared with a learned per-position reference).
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#ifndef SPEED_MONITOR_H_
+#define SPEED_MONITOR_H_
+
+#include "stm32f429xx.h"     // Include necessary STM32F4xx headers
+#include "stm32f4xx_hal.h"   // Include necessary STM32F4xx HAL headers
+#include <stdint.h>          // Include standard integer types
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Speed pulses (encoder channel A, also wired to PH10) captured by TIM5 CH1, 1 us resolution.
+ * TIM5 is 32-bit: one capture register difference is the period, without overflow handling. */
+#define SPEED_MONITOR_TIMER            TIM5
+#define SPEED_MONITOR_CHANNEL          TIM_CHANNEL_1
+#define SPEED_MONITOR_GPIO_PORT        GPIOH
+#define SPEED_MONITOR_PIN_ID           GPIO_PIN_10
+#define SPEED_MONITOR_PIN_AF           GPIO_AF2_TIM5
+#define SPEED_MONITOR_IRQn             TIM5_IRQn
+#define SPEED_MONITOR_CAPTURE_PSC      TIM_ICPSC_DIV8   /* One capture (one interrupt) every 8 edges */
+#define SPEED_MONITOR_INPUT_FILTER     (6U)
+
+/* Learned reference: one period per position bin (0.1 % positions 0 .. 1000), from the
+ * mean period of each bin over the previous clean closes */
+#define SPEED_MONITOR_BINS             (64U)
+
+#define __SPEED_MONITOR_TIMER_CLK_ENABLE()   __HAL_RCC_TIM5_CLK_ENABLE()
+#define __SPEED_MONITOR_PORT_CLK_ENABLE()    __HAL_RCC_GPIOH_CLK_ENABLE()
+
+typedef struct
+{
+    uint8_t dropPercent;        // Speed drop below the reference reported as a jam
+    uint8_t learnShift;         // Reference EMA: reference += (run period - reference) >> learnShift
+    uint8_t minimumRuns;        // Clean closes through a bin before it is checked
+    uint8_t blankingPeriods;    // Periods ignored after arming (motor speeding up)
+    uint8_t settlePeriods;      // Periods ignored when the duty cycle returns to referenceSpeed
+    uint8_t referenceSpeed;     // Duty cycle (percent) the reference is learned and checked at
+} SpeedMonitor_ConfigTypeDef;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize the detector (references cleared, disarmed).
+ *
+ * Parameters:
+ * - config: Pointer to the detector settings (kept by reference).
+ *
+ * Return:
+ * - None
+ */
+void SpeedMonitor_Init(const SpeedMonitor_ConfigTypeDef *config);
+
+/*
+ * Description :
+ * Start the speed pulse input capture; every capture is reported to
+ * SpeedMonitor_CaptureCallback(). Not needed when the periods come from
+ * another source (e.g. the ripple counter).
+ */
+void SpeedMonitor_StartCapture(void);
+
+/*
+ * Description :
+ * Start recording a closing run into the scratch profile (no effect while a run
+ * is already recorded or the previous one is not merged yet).
+ */
+void SpeedMonitor_StartRun(void);
+
+/*
+ * Description :
+ * End the closing run. A clean run (closed up to the limit switch, no jam) is merged
+ * into the reference by SpeedMonitor_Service(), any other run is dropped.
+ *
+ * Parameters:
+ * - clean: 1 for a clean close.
+ *
+ * Return:
+ * - None
+ */
+void SpeedMonitor_EndRun(uint8_t clean);
+
+/*
+ * Description :
+ * Housekeeping, called periodically from a low priority task: merges a clean run
+ * into the reference.
+ */
+void SpeedMonitor_Service(void);
+
+/*
+ * Description :
+ * Arm the detector (motor started). The first config->blankingPeriods periods
+ * are ignored.
+ */
+void SpeedMonitor_Arm(void);
+
+/*
+ * Description :
+ * Duty cycle set point of the running motor. The motor speed is not proportional to
+ * the duty cycle (friction, load), so the reference is only valid at the duty cycle
+ * it was learned at: at any other set point (e.g. the slow approach of a positioning
+ * move) the periods are neither checked nor recorded. Back at config->referenceSpeed
+ * the next config->settlePeriods periods are ignored while the motor accelerates.
+ *
+ * Parameters:
+ * - speed: Duty cycle in percent.
+ *
+ * Return:
+ * - None
+ */
+void SpeedMonitor_SetSpeed(uint8_t speed);
+
+/*
+ * Description :
+ * Disarm the detector (motor stopped).
+ */
+void SpeedMonitor_Disarm(void);
+
+/*
+ * Description :
+ * Check one measured period against the reference of its position, then record it
+ * in the run (only at the reference duty cycle, see SpeedMonitor_SetSpeed()). O(1), called from interrupt context (input capture or current sense
+ * blocks). The reference only changes when a clean run is merged, so a motor slowing
+ * down during the run cannot drag it along. The detector disarms itself when it
+ * reports a jam.
+ *
+ * Parameters:
+ * - periodUs: Time between two speed pulses, in microseconds.
+ * - position: Window position in 0.1 % (0 .. 1000).
+ *
+ * Return:
+ * - uint8_t: 1 if the speed dropped more than config->dropPercent below the reference.
+ */
+uint8_t SpeedMonitor_Check(uint32_t periodUs, uint16_t position);
+
+/*
+ * Description :
+ * Capture notification, called from the timer interrupt with the measured period.
+ * Weak: override it in the application to call SpeedMonitor_Check() with the position.
+ *
+ * Parameters:
+ * - periodUs: Time between two captures, in microseconds.
+ * - timestamp: CycleCounter_Get() at the interrupt entry (start of a detection-to-stop measurement).
+ *
+ * Return:
+ * - None
+ */
+void SpeedMonitor_CaptureCallback(uint32_t periodUs, uint32_t timestamp);
+
+/*
+ * Description :
+ * Timer interrupt service, called from the SPEED_MONITOR_IRQn handler.
+ */
+void SpeedMonitor_IRQHandler(void);
+
+#endif /* SPEED_MONITOR_H_ */
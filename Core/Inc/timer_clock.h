@@ -0,0 +1,38 @@
+/******************************************************************************
+ *
+ * Module: TIMER CLOCK
+ *
+ * File Name: timer_clock.h
+ *
+ * Description: Header file for the timer kernel clock helper, shared by every
+ *              driver that derives a prescaler or a period from the clock tree.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#ifndef TIMER_CLOCK_H_
+#define TIMER_CLOCK_H_
+
+#include "stm32f429xx.h"     // Include necessary STM32F4xx headers
+#include "stm32f4xx_hal.h"   // Include necessary STM32F4xx HAL headers
+#include <stdint.h>          // Include standard integer types
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Return the kernel clock of a timer: PCLK2 for the APB2 timers (TIM1, TIM8 - TIM11),
+ * PCLK1 for the others, doubled when the APB prescaler divides (RCC TIMPRE = 0).
+ *
+ * Parameters:
+ * - instance: Timer instance (TIM1 ... TIM14).
+ *
+ * Return:
+ * - uint32_t: Timer clock in Hz.
+ */
+uint32_t TimerClock_GetFrequency(const TIM_TypeDef *instance);
+
+#endif /* TIMER_CLOCK_H_ */
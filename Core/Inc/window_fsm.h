@@ -0,0 +1,105 @@
+/******************************************************************************
+ *
+ * Module: WINDOW FSM
+ *
+ * File Name: window_fsm.h
+ *
+ * Description: Header file for the table-driven window panel state machine
+ *              (manual / one-touch travels, jam reversal and lock of a panel).
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#ifndef WINDOW_FSM_H_
+#define WINDOW_FSM_H_
+
+#include <stdint.h>          // Include standard integer types
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Leaf states, then the superstates they inherit unhandled events from:
+ *   ACTIVE  <- IDLE, MOVING
+ *   MOVING  <- MANUAL_UP, AUTO_UP, MANUAL_DOWN, AUTO_DOWN
+ * JAM_REVERSE and LOCKED have no parent: every other event is ignored there. */
+typedef enum {
+    WINDOW_STATE_NONE,          // Table entry: event not handled (ask the parent state)
+    WINDOW_STATE_IDLE,
+    WINDOW_STATE_MANUAL_UP,     // Up button held, window moving up
+    WINDOW_STATE_AUTO_UP,       // One-touch travel up
+    WINDOW_STATE_MANUAL_DOWN,
+    WINDOW_STATE_AUTO_DOWN,
+    WINDOW_STATE_JAM_REVERSE,   // Jam reversal in progress, the panel is ignored
+    WINDOW_STATE_LOCKED,        // Panel locked from the driver side
+    WINDOW_STATE_MOVING,        // Superstate
+    WINDOW_STATE_ACTIVE,        // Superstate
+    WINDOW_NUM_STATES
+} WindowFsm_State_e;
+
+typedef enum {
+    WINDOW_EVT_UP_PRESS,
+    WINDOW_EVT_UP_RELEASE_SHORT,    // Short press: one-touch travel
+    WINDOW_EVT_UP_RELEASE_LONG,     // Long press: manual travel ends at release
+    WINDOW_EVT_UP_RELEASE_DOUBLE,   // Second short press within the gap: the travel stops at release
+    WINDOW_EVT_DOWN_PRESS,
+    WINDOW_EVT_DOWN_RELEASE_SHORT,
+    WINDOW_EVT_DOWN_RELEASE_LONG,
+    WINDOW_EVT_DOWN_RELEASE_DOUBLE,
+    WINDOW_EVT_TRAVEL_END,          // The motor no longer runs the travel of this panel
+    WINDOW_EVT_JAM,
+    WINDOW_EVT_JAM_END,
+    WINDOW_EVT_LOCK,
+    WINDOW_EVT_UNLOCK,
+    WINDOW_NUM_EVENTS
+} WindowFsm_Event_e;
+
+typedef enum {
+    WINDOW_ACTION_NONE, WINDOW_ACTION_UP, WINDOW_ACTION_DOWN, WINDOW_ACTION_STOP
+} WindowFsm_Action_e;
+
+typedef struct
+{
+    uint8_t next;       // WindowFsm_State_e
+    uint8_t action;     // WindowFsm_Action_e
+} WindowFsm_TransitionTypeDef;
+
+typedef struct
+{
+    volatile WindowFsm_State_e state;
+    uint32_t dispatchCycles;        // Cost of the last dispatch, in CPU cycles
+    uint32_t maxDispatchCycles;
+} WindowFsm_TypeDef;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize a panel state machine in WINDOW_STATE_IDLE.
+ */
+void WindowFsm_Init(WindowFsm_TypeDef *fsm);
+
+/*
+ * Description :
+ * Dispatch one event: the transition of the current state, or of its nearest
+ * superstate handling the event, is taken. O(1) table lookups.
+ *
+ * Parameters:
+ * - fsm: Pointer to the panel state machine.
+ * - event: Event to dispatch.
+ *
+ * Return:
+ * - WindowFsm_Action_e: Motor action of the transition (WINDOW_ACTION_NONE if the event is ignored).
+ */
+WindowFsm_Action_e WindowFsm_Dispatch(WindowFsm_TypeDef *fsm, WindowFsm_Event_e event);
+
+/*
+ * Description :
+ * Return 1 if the state is one of the moving states.
+ */
+uint8_t WindowFsm_IsMoving(WindowFsm_State_e state);
+
+#endif /* WINDOW_FSM_H_ */
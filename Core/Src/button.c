@@ -50,6 +50,39 @@ void BUTTON_Init(BUTTON_TypeDef *BUTTONx)
     HAL_GPIO_Init(BUTTONx->GPIOx, &GPIO_InitStruct);
 }
 
+/*
+ * Function: BUTTON_InitInterrupt
+ * ----------------------------
+ *   Initialize the Button Pin as an external interrupt source.
+ *
+ *   This function configures the button pin like BUTTON_Init() (input with internal
+ *   pull-up) but also routes it to its EXTI line, triggering on both the press (falling)
+ *   and the release (rising) edge.
+ *
+ *   BUTTONx: A pointer to the Button structure containing the port and pin information.
+ *
+ *   Preconditions:
+ *     Same as BUTTON_Init(). The matching EXTIx_IRQn must be enabled in the NVIC
+ *     (see MX_NVIC_Init()) for the interrupt to be delivered.
+ *
+ *   Returns: None
+ */
+void BUTTON_InitInterrupt(BUTTON_TypeDef *BUTTONx)
+{
+    if (BUTTONx == NULL)
+        return;
+
+    GPIO_InitTypeDef GPIO_InitStruct = { 0 };
+
+    /* Configure GPIO pins (HAL_GPIO_Init also enables SYSCFG and selects the EXTI port) */
+    GPIO_InitStruct.Pin = BUTTONx->GPIO_pin;
+    GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING_FALLING;
+    GPIO_InitStruct.Pull = GPIO_PULLUP;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+
+    HAL_GPIO_Init(BUTTONx->GPIOx, &GPIO_InitStruct);
+}
+
 /*
  * Function: BUTTON_IsPressed
  * ----------------------------
@@ -0,0 +1,282 @@
+/******************************************************************************
+ *
+ * Module: CURRENT SENSE
+ *
+ * File Name: current_sense.c
+ *
+ * Description: Source file for the motor current sense driver and anti-pinch detector.
+ *
+ *   TIM3 triggers one ADC conversion per sample period and the DMA stores the
+ *   results in a circular buffer of two blocks. The half-transfer and
+ *   transfer-complete interrupts hand over one complete block while the DMA fills
+ *   the other one, so the CPU never handles a single conversion. The ADC is driven
+ *   at register level (the HAL ADC driver is not part of the project).
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#include "current_sense.h"
+#include "timer_clock.h"
+#include "main.h"          // Error_Handler()
+
+/*******************************************************************************
+ *                           Private Variables                                 *
+ *******************************************************************************/
+
+static TIM_HandleTypeDef CurrentSense_TimerHandle;
+static DMA_HandleTypeDef CurrentSense_DmaHandle;
+
+/* Ping-pong buffer: block 0 is processed while the DMA fills block 1 and vice versa */
+static volatile uint16_t CurrentSense_Buffer[2U * CURRENT_SENSE_BLOCK_SIZE];
+
+static const CurrentSense_ConfigTypeDef *CurrentSense_Config;
+static volatile uint16_t CurrentSense_Level;          // Mean of the last block
+static volatile uint16_t CurrentSense_Threshold;      // Pinch threshold in use, in ADC counts
+static uint16_t CurrentSense_PreviousLevel;
+static volatile uint8_t CurrentSense_Armed;
+static volatile uint16_t CurrentSense_BlankingBlocks;
+
+/*******************************************************************************
+ *                           Private Functions                                 *
+ *******************************************************************************/
+
+/* Threshold + slope detector on the mean of one block */
+static void CurrentSense_ProcessBlock(const volatile uint16_t *block)
+{
+    uint32_t sum = 0;
+    uint32_t i;
+    uint16_t level;
+
+    for (i = 0; i < CURRENT_SENSE_BLOCK_SIZE; i++)
+        sum += block[i];
+
+    level = (uint16_t)(sum >> CURRENT_SENSE_BLOCK_SHIFT);
+    CurrentSense_Level = level;
+
+    if (CurrentSense_Armed && (CurrentSense_Config != NULL))
+    {
+        if (CurrentSense_BlankingBlocks != 0)
+        {
+            CurrentSense_BlankingBlocks--;
+        }
+        else if ((level >= CurrentSense_Threshold) ||
+                 ((level > CurrentSense_PreviousLevel) &&
+                  ((level - CurrentSense_PreviousLevel) >= CurrentSense_Config->slope)))
+        {
+            CurrentSense_Armed = 0;
+            CurrentSense_PinchCallback(level);
+        }
+    }
+
+    CurrentSense_PreviousLevel = level;
+
+    CurrentSense_BlockCallback(block);
+}
+
+static void CurrentSense_HalfTransfer(DMA_HandleTypeDef *hdma)
+{
+    UNUSED(hdma);
+    CurrentSense_ProcessBlock(&CurrentSense_Buffer[0]);
+}
+
+static void CurrentSense_FullTransfer(DMA_HandleTypeDef *hdma)
+{
+    UNUSED(hdma);
+    CurrentSense_ProcessBlock(&CurrentSense_Buffer[CURRENT_SENSE_BLOCK_SIZE]);
+}
+
+/*******************************************************************************
+ *                           Functions Definitions                             *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Configure the ADC, its trigger timer and the circular DMA, and start sampling.
+ *
+ * Parameters:
+ * - config: Pointer to the detector thresholds (kept by reference).
+ *
+ * Return:
+ * - None
+ */
+void CurrentSense_Init(const CurrentSense_ConfigTypeDef *config)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = { 0 };
+    TIM_MasterConfigTypeDef sMasterConfig = { 0 };
+
+    CurrentSense_Config = config;
+    CurrentSense_Armed = 0;
+    CurrentSense_Threshold = (config != NULL)? config->threshold : 0xFFFFU;
+
+    __CURRENT_SENSE_PORT_CLK_ENABLE();
+    __CURRENT_SENSE_ADC_CLK_ENABLE();
+    __CURRENT_SENSE_TIMER_CLK_ENABLE();
+    __CURRENT_SENSE_DMA_CLK_ENABLE();
+
+    GPIO_InitStruct.Pin = CURRENT_SENSE_PIN_ID;
+    GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    HAL_GPIO_Init(CURRENT_SENSE_GPIO_PORT, &GPIO_InitStruct);
+
+    /* DMA: ADC data register -> ping-pong buffer, circular, interrupt at each half */
+    CurrentSense_DmaHandle.Instance = CURRENT_SENSE_DMA_STREAM;
+    CurrentSense_DmaHandle.Init.Channel = CURRENT_SENSE_DMA_CHANNEL;
+    CurrentSense_DmaHandle.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    CurrentSense_DmaHandle.Init.PeriphInc = DMA_PINC_DISABLE;
+    CurrentSense_DmaHandle.Init.MemInc = DMA_MINC_ENABLE;
+    CurrentSense_DmaHandle.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    CurrentSense_DmaHandle.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    CurrentSense_DmaHandle.Init.Mode = DMA_CIRCULAR;
+    CurrentSense_DmaHandle.Init.Priority = DMA_PRIORITY_HIGH;
+    CurrentSense_DmaHandle.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+
+    if (HAL_DMA_Init(&CurrentSense_DmaHandle) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    CurrentSense_DmaHandle.XferHalfCpltCallback = CurrentSense_HalfTransfer;
+    CurrentSense_DmaHandle.XferCpltCallback = CurrentSense_FullTransfer;
+
+    /* Same priority as the other motor cut-off interrupts (limit switches, ramp DMA) */
+    HAL_NVIC_SetPriority(CURRENT_SENSE_DMA_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(CURRENT_SENSE_DMA_IRQn);
+
+    if (HAL_DMA_Start_IT(&CurrentSense_DmaHandle, (uint32_t)&CURRENT_SENSE_ADC->DR,
+                         (uint32_t)CurrentSense_Buffer, 2U * CURRENT_SENSE_BLOCK_SIZE) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    /* ADC: 12-bit, single channel, 56 cycles sampling, ADCCLK = PCLK2 / 4 */
+    ADC->CCR = (ADC->CCR & ~ADC_CCR_ADCPRE) | ADC_CCR_ADCPRE_0;
+    CURRENT_SENSE_ADC->CR1 = 0;
+    CURRENT_SENSE_ADC->SMPR2 = (3UL << (3U * CURRENT_SENSE_ADC_CHANNEL));
+    CURRENT_SENSE_ADC->SQR1 = 0;                           // One conversion per trigger
+    CURRENT_SENSE_ADC->SQR3 = CURRENT_SENSE_ADC_CHANNEL;
+
+    /* Conversion on the rising edge of TIM3 TRGO, DMA request after every conversion */
+    CURRENT_SENSE_ADC->CR2 = ADC_CR2_EXTEN_0 | ADC_CR2_EXTSEL_3 | ADC_CR2_DMA | ADC_CR2_DDS | ADC_CR2_ADON;
+
+    /* Trigger timer: one update (TRGO) per sample period */
+    CurrentSense_TimerHandle.Instance = CURRENT_SENSE_TIMER;
+    CurrentSense_TimerHandle.Init.Prescaler = 0;
+    CurrentSense_TimerHandle.Init.CounterMode = TIM_COUNTERMODE_UP;
+    CurrentSense_TimerHandle.Init.Period = (TimerClock_GetFrequency(CURRENT_SENSE_TIMER) / CURRENT_SENSE_SAMPLE_RATE_HZ) - 1U;
+    CurrentSense_TimerHandle.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    CurrentSense_TimerHandle.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+
+    if (HAL_TIM_Base_Init(&CurrentSense_TimerHandle) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    sMasterConfig.MasterOutputTrigger = TIM_TRGO_UPDATE;
+    sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+
+    if (HAL_TIMEx_MasterConfigSynchronization(&CurrentSense_TimerHandle, &sMasterConfig) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    if (HAL_TIM_Base_Start(&CurrentSense_TimerHandle) != HAL_OK)
+    {
+        Error_Handler();
+    }
+}
+
+/*
+ * Description :
+ * Arm the pinch detector, the first config->blankingBlocks blocks are ignored.
+ */
+void CurrentSense_Arm(void)
+{
+    if (CurrentSense_Config == NULL)
+        return;
+
+    CurrentSense_BlankingBlocks = CurrentSense_Config->blankingBlocks;
+    CurrentSense_Armed = 1;
+}
+
+/*
+ * Description :
+ * Ignore the next config->settleBlocks blocks (speed increase of the running motor).
+ */
+void CurrentSense_Settle(void)
+{
+    if ((CurrentSense_Config == NULL) || !CurrentSense_Armed)
+        return;
+
+    if (CurrentSense_BlankingBlocks < CurrentSense_Config->settleBlocks)
+        CurrentSense_BlankingBlocks = CurrentSense_Config->settleBlocks;
+}
+
+/*
+ * Description :
+ * Disarm the pinch detector.
+ */
+void CurrentSense_Disarm(void)
+{
+    CurrentSense_Armed = 0;
+}
+
+/*
+ * Description :
+ * Return 1 while the detector is armed and past its blanking blocks.
+ */
+uint8_t CurrentSense_IsMonitoring(void)
+{
+    return (CurrentSense_Armed && (CurrentSense_BlankingBlocks == 0))? 1U : 0U;
+}
+
+/*
+ * Description :
+ * Replace the pinch threshold, used from the next block on.
+ *
+ * Parameters:
+ * - threshold: Block mean (ADC counts) reported as a pinch.
+ *
+ * Return:
+ * - None
+ */
+void CurrentSense_SetThreshold(uint16_t threshold)
+{
+    CurrentSense_Threshold = threshold;
+}
+
+/*
+ * Description :
+ * Return the mean of the last block of samples, in ADC counts.
+ */
+uint16_t CurrentSense_GetLevel(void)
+{
+    return CurrentSense_Level;
+}
+
+/*
+ * Description :
+ * DMA interrupt service: one call per completed block.
+ */
+void CurrentSense_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&CurrentSense_DmaHandle);
+}
+
+/*
+ * Description :
+ * Pinch notification. Weak: override it in the application.
+ */
+__weak void CurrentSense_PinchCallback(uint16_t level)
+{
+    UNUSED(level);
+}
+
+/*
+ * Description :
+ * Block notification. Weak: override it in the application.
+ */
+__weak void CurrentSense_BlockCallback(const volatile uint16_t *block)
+{
+    UNUSED(block);
+}
@@ -0,0 +1,53 @@
+/******************************************************************************
+ *
+ * Module: CYCLE COUNTER
+ *
+ * File Name: cycle_counter.c
+ *
+ * Description: Source file for the DWT cycle counter used for latency measurements.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#include "cycle_counter.h"
+
+/*******************************************************************************
+ *                           Functions Definitions                             *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Enable the DWT cycle counter (CYCCNT) and reset it to zero.
+ *
+ * Return:
+ * - None
+ */
+void CycleCounter_Init(void)
+{
+    /* The DWT unit is only clocked once trace is enabled in the debug monitor */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/*
+ * Description :
+ * Convert a number of core clock cycles to microseconds using SystemCoreClock.
+ *
+ * Parameters:
+ * - cycles: Elapsed cycles (difference of two CycleCounter_Get() timestamps).
+ *
+ * Return:
+ * - uint32_t: The elapsed time in microseconds.
+ */
+uint32_t CycleCounter_ToMicroseconds(uint32_t cycles)
+{
+    uint32_t cyclesPerMicrosecond = SystemCoreClock / 1000000U;
+
+    if (cyclesPerMicrosecond == 0)
+        return cycles;
+
+    return (cycles / cyclesPerMicrosecond);
+}
@@ -11,6 +11,131 @@
  *******************************************************************************/
 
 #include "dc_motor.h"
+#include "timer_clock.h"
+#include "main.h"          // Error_Handler()
+
+/*******************************************************************************
+ *                           Private Variables                                 *
+ *******************************************************************************/
+
+static TIM_HandleTypeDef DcMotor_PwmHandle;
+static TIM_HandleTypeDef DcMotor_RampTimerHandle;
+static DMA_HandleTypeDef DcMotor_RampDmaHandle;
+
+/* Compare values copied one by one into MOTOR_PWM_COMPARE_REG by the DMA */
+static uint16_t DcMotor_RampTable[MOTOR_RAMP_MAX_STEPS];
+
+static uint32_t DcMotor_PwmPeriod;                      // PWM period in timer ticks (100 % duty)
+static uint32_t DcMotor_SpeedCompare;                   // Speed set point as a compare value
+static uint8_t DcMotor_SpeedPercent = MOTOR_DEFAULT_SPEED;  // Speed set point in percent
+static uint16_t DcMotor_AccelerationMs = MOTOR_DEFAULT_ACCEL_MS;
+static uint16_t DcMotor_DecelerationMs = MOTOR_DEFAULT_DECEL_MS;
+
+static volatile DcMotor_State DcMotor_CurrentState = STOP;
+static volatile uint8_t DcMotor_StopAtRampEnd = 0;      // Soft stop in progress
+
+/* IN1/IN2 of every state as one BSRR word: set bits in the low half, reset bits in the high half */
+static const uint32_t DcMotor_BsrrTable[DCMOTOR_NUM_STATES] = {
+	[STOP]           = ((uint32_t)(MOTOR_IN1_PIN_ID | MOTOR_IN2_PIN_ID) << 16U),
+	[Anti_ClockWise] = (uint32_t)MOTOR_IN1_PIN_ID | ((uint32_t)MOTOR_IN2_PIN_ID << 16U),
+	[ClockWise]      = ((uint32_t)MOTOR_IN1_PIN_ID << 16U) | (uint32_t)MOTOR_IN2_PIN_ID,
+	[BRAKE]          = (uint32_t)(MOTOR_IN1_PIN_ID | MOTOR_IN2_PIN_ID),
+};
+
+static volatile uint32_t DcMotor_TransitionCycles[DCMOTOR_NUM_STATES];
+
+/*******************************************************************************
+ *                           Private Functions                                 *
+ *******************************************************************************/
+
+/* Drive the two H-bridge direction pins at once: no intermediate IN1/IN2 combination */
+static inline void DcMotor_WriteDirection(DcMotor_State state)
+{
+	MOTOR_GPIO_PORT->BSRR = DcMotor_BsrrTable[state];
+}
+
+/* Keep both IN pins low for MOTOR_DEAD_TIME_US */
+static void DcMotor_DeadTime(void)
+{
+	uint32_t start = CycleCounter_Get();
+	uint32_t cycles = (SystemCoreClock / 1000000U) * MOTOR_DEAD_TIME_US;
+
+	while ((CycleCounter_Get() - start) < cycles)
+		;
+}
+
+/* Stop the running ramp (if any), the duty cycle stays where the ramp left it */
+static void DcMotor_AbortRamp(void)
+{
+	MOTOR_RAMP_TIMER->CR1 &= ~TIM_CR1_CEN;         // No more DMA requests
+	MOTOR_RAMP_DMA_STREAM->CR &= ~(DMA_SxCR_EN | DMA_SxCR_TCIE);
+	while (MOTOR_RAMP_DMA_STREAM->CR & DMA_SxCR_EN)
+		;
+	DcMotor_StopAtRampEnd = 0;
+}
+
+/* Ramp finished: complete a soft stop */
+static void DcMotor_RampEnd(void)
+{
+	if (DcMotor_StopAtRampEnd) {
+		DcMotor_StopAtRampEnd = 0;
+		DcMotor_WriteDirection(STOP);
+		DcMotor_CurrentState = STOP;
+		DcMotor_StateCallback(STOP, DcMotor_SpeedPercent);
+	}
+}
+
+/*
+ * Build a linear ramp from the current compare value to targetCompare and hand it to
+ * the DMA. The ramp slope follows the acceleration or deceleration setting.
+ * Not reentrant: call it with the ramp DMA interrupt masked (or from an interrupt of
+ * the same priority).
+ */
+static void DcMotor_StartRamp(uint32_t targetCompare, uint8_t stopAtEnd)
+{
+	uint32_t current;
+	uint32_t delta;
+	uint32_t steps;
+	uint32_t i;
+	uint16_t fullScaleMs;
+
+	DcMotor_AbortRamp();
+	DcMotor_StopAtRampEnd = stopAtEnd;
+
+	current = MOTOR_PWM_COMPARE_REG;
+	delta = (targetCompare > current)? (targetCompare - current) : (current - targetCompare);
+	fullScaleMs = (targetCompare > current)? DcMotor_AccelerationMs : DcMotor_DecelerationMs;
+
+	/* Number of ramp steps for this part of the full scale */
+	steps = (delta * (((uint32_t)fullScaleMs * 1000U) / MOTOR_RAMP_STEP_US)) / DcMotor_PwmPeriod;
+
+	if (steps == 0) {
+		MOTOR_PWM_COMPARE_REG = targetCompare;
+		DcMotor_RampEnd();
+		return;
+	}
+
+	if (steps > MOTOR_RAMP_MAX_STEPS)
+		steps = MOTOR_RAMP_MAX_STEPS;
+
+	for (i = 0; i < steps; i++) {
+		DcMotor_RampTable[i] = (uint16_t)((int32_t)current
+				+ (((int32_t)targetCompare - (int32_t)current) * (int32_t)(i + 1U)) / (int32_t)steps);
+	}
+
+	__HAL_DMA_CLEAR_FLAG(&DcMotor_RampDmaHandle,
+			__HAL_DMA_GET_TC_FLAG_INDEX(&DcMotor_RampDmaHandle) | __HAL_DMA_GET_HT_FLAG_INDEX(&DcMotor_RampDmaHandle)
+			| __HAL_DMA_GET_TE_FLAG_INDEX(&DcMotor_RampDmaHandle) | __HAL_DMA_GET_DME_FLAG_INDEX(&DcMotor_RampDmaHandle)
+			| __HAL_DMA_GET_FE_FLAG_INDEX(&DcMotor_RampDmaHandle));
+
+	MOTOR_RAMP_DMA_STREAM->M0AR = (uint32_t)DcMotor_RampTable;
+	MOTOR_RAMP_DMA_STREAM->NDTR = steps;
+	MOTOR_RAMP_DMA_STREAM->CR |= DMA_SxCR_TCIE | DMA_SxCR_EN;
+
+	/* One compare value per ramp timer update, without any CPU involvement */
+	MOTOR_RAMP_TIMER->CNT = 0;
+	MOTOR_RAMP_TIMER->CR1 |= TIM_CR1_CEN;
+}
 
 /*******************************************************************************
  *                           Functions Definitions                             *
@@ -19,62 +144,266 @@
 /*
  Description
  1) The Function responsible for setup the direction for the two motor pins through the GPIO driver.
- 2) Stop at the DC-Motor at the beginning through the GPIO driver.
+ 2) Setup the EN1 PWM timer and the DMA driven speed ramp.
+ 3) Stop at the DC-Motor at the beginning through the GPIO driver.
  */
 void DcMotor_Init(void)
 {
 	GPIO_InitTypeDef GPIO_InitStruct = { 0 };
+	TIM_OC_InitTypeDef sConfigOC = { 0 };
 
 	__MOTOR_PORT_CLK_ENABLE();
+	__MOTOR_PWM_TIMER_CLK_ENABLE();
+	__MOTOR_RAMP_TIMER_CLK_ENABLE();
+	__MOTOR_RAMP_DMA_CLK_ENABLE();
 
 	/* Configure GPIO pins */
-	GPIO_InitStruct.Pin = MOTOR_IN1_PIN_ID | MOTOR_IN2_PIN_ID | MOTOR_EN1_PIN_ID;
+	GPIO_InitStruct.Pin = MOTOR_IN1_PIN_ID | MOTOR_IN2_PIN_ID;
 	GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
 	GPIO_InitStruct.Pull = GPIO_PULLDOWN;
 	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
 
 	HAL_GPIO_Init(MOTOR_GPIO_PORT, &GPIO_InitStruct);
 
+	/* EN1 is driven by the PWM timer channel */
+	GPIO_InitStruct.Pin = MOTOR_EN1_PIN_ID;
+	GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+	GPIO_InitStruct.Alternate = MOTOR_EN1_PIN_AF;
+
+	HAL_GPIO_Init(MOTOR_GPIO_PORT, &GPIO_InitStruct);
+
 	/* Configure GPIO pin Output Level */
 	/* Stop the DC-Motor at the beginning (IN1 = 0, IN2 = 0) */
-	HAL_GPIO_WritePin(MOTOR_GPIO_PORT, MOTOR_IN1_PIN_ID, GPIO_PIN_RESET);
-	HAL_GPIO_WritePin(MOTOR_GPIO_PORT, MOTOR_IN2_PIN_ID, GPIO_PIN_RESET);
+	DcMotor_WriteDirection(STOP);
+
+	/* PWM timer: MOTOR_PWM_FREQUENCY_HZ, duty cycle 0 until the motor is started */
+	DcMotor_PwmPeriod = TimerClock_GetFrequency(MOTOR_PWM_TIMER) / MOTOR_PWM_FREQUENCY_HZ;
+	DcMotor_SpeedCompare = (DcMotor_PwmPeriod * MOTOR_DEFAULT_SPEED) / 100U;
+
+	DcMotor_PwmHandle.Instance = MOTOR_PWM_TIMER;
+	DcMotor_PwmHandle.Init.Prescaler = 0;
+	DcMotor_PwmHandle.Init.CounterMode = TIM_COUNTERMODE_UP;
+	DcMotor_PwmHandle.Init.Period = DcMotor_PwmPeriod - 1U;
+	DcMotor_PwmHandle.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+	DcMotor_PwmHandle.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+
+	if (HAL_TIM_PWM_Init(&DcMotor_PwmHandle) != HAL_OK) {
+		Error_Handler();
+	}
+
+	/* Compare preload: a new duty cycle only applies at the next PWM period (no glitches) */
+	sConfigOC.OCMode = TIM_OCMODE_PWM1;
+	sConfigOC.Pulse = 0;
+	sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+	sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+
+	if (HAL_TIM_PWM_ConfigChannel(&DcMotor_PwmHandle, &sConfigOC, MOTOR_PWM_CHANNEL) != HAL_OK) {
+		Error_Handler();
+	}
+
+	/* Ramp timer: one update event (one DMA request) every MOTOR_RAMP_STEP_US */
+	DcMotor_RampTimerHandle.Instance = MOTOR_RAMP_TIMER;
+	DcMotor_RampTimerHandle.Init.Prescaler = (TimerClock_GetFrequency(MOTOR_RAMP_TIMER) / 1000000U) - 1U;
+	DcMotor_RampTimerHandle.Init.CounterMode = TIM_COUNTERMODE_UP;
+	DcMotor_RampTimerHandle.Init.Period = MOTOR_RAMP_STEP_US - 1U;
+	DcMotor_RampTimerHandle.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+	DcMotor_RampTimerHandle.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+
+	if (HAL_TIM_Base_Init(&DcMotor_RampTimerHandle) != HAL_OK) {
+		Error_Handler();
+	}
+
+	__HAL_TIM_ENABLE_DMA(&DcMotor_RampTimerHandle, TIM_DMA_UPDATE);
+
+	/* Ramp DMA: ramp table (memory) -> PWM compare register, one half-word per request */
+	DcMotor_RampDmaHandle.Instance = MOTOR_RAMP_DMA_STREAM;
+	DcMotor_RampDmaHandle.Init.Channel = MOTOR_RAMP_DMA_CHANNEL;
+	DcMotor_RampDmaHandle.Init.Direction = DMA_MEMORY_TO_PERIPH;
+	DcMotor_RampDmaHandle.Init.PeriphInc = DMA_PINC_DISABLE;
+	DcMotor_RampDmaHandle.Init.MemInc = DMA_MINC_ENABLE;
+	DcMotor_RampDmaHandle.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+	DcMotor_RampDmaHandle.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+	DcMotor_RampDmaHandle.Init.Mode = DMA_NORMAL;
+	DcMotor_RampDmaHandle.Init.Priority = DMA_PRIORITY_HIGH;
+	DcMotor_RampDmaHandle.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+
+	if (HAL_DMA_Init(&DcMotor_RampDmaHandle) != HAL_OK) {
+		Error_Handler();
+	}
+
+	MOTOR_RAMP_DMA_STREAM->PAR = (uint32_t)&MOTOR_PWM_COMPARE_REG;
+
+	/* Same priority as the limit switches, masked by the kernel critical sections */
+	HAL_NVIC_SetPriority(MOTOR_RAMP_DMA_IRQn, 5, 0);
+	HAL_NVIC_EnableIRQ(MOTOR_RAMP_DMA_IRQn);
+
+	if (HAL_TIM_PWM_Start(&DcMotor_PwmHandle, MOTOR_PWM_CHANNEL) != HAL_OK) {
+		Error_Handler();
+	}
 }
 
 /*
  Description:
- 1) The function responsible for rotate the DC Motor CW/ or A-CW or stop the motor based on the state input state value.
+ 1) The function responsible for rotate the DC Motor CW/ or A-CW, stop or brake the motor based on the state input state value.
+    Every transition is a single BSRR write of both IN pins, a reversal goes through
+    STOP for MOTOR_DEAD_TIME_US first.
 
- 2) Send the required duty cycle to the PWM driver based on the required speed value.
+ 2) CW/A-CW soft-start: the duty cycle ramps from its current value up to the speed set by DcMotor_SetSpeed().
+    STOP is immediate (used for limit switches and jams), see DcMotor_Stop() for a soft stop.
 
  Inputs:
- 1) State: The required DC Motor state, it should be CW or A-CW or stop.
+ 1) State: The required DC Motor state, it should be CW or A-CW or stop (coast) or brake.
  DcMotor_State data type should be declared as enum or uint8.
 
  Return: None
  */
 void DcMotor_Rotate(DcMotor_State state) {
+	uint32_t start = CycleCounter_Get();
+	DcMotor_State previous = DcMotor_CurrentState;
 
-	HAL_GPIO_WritePin(MOTOR_GPIO_PORT, MOTOR_EN1_PIN_ID, GPIO_PIN_SET);
-
-	/* Setting the DC Motor rotation direction (CW/ or A-CW or stop) based on the state value. */
+	/* Setting the DC Motor rotation direction (CW/ or A-CW or stop or brake) based on the state value. */
 	switch (state) {
 	case STOP:
-		/* Stop the DC-Motor (IN1 = 0, IN2 = 0) */
-		HAL_GPIO_WritePin(MOTOR_GPIO_PORT, MOTOR_IN1_PIN_ID, GPIO_PIN_RESET);
-		HAL_GPIO_WritePin(MOTOR_GPIO_PORT, MOTOR_IN2_PIN_ID, GPIO_PIN_RESET);
+		DcMotor_WriteDirection(STOP);    // Outputs first: the ramp DMA cannot drive a bridge with both IN low
+		DcMotor_AbortRamp();
+		MOTOR_PWM_COMPARE_REG = 0;
 		break;
-	case ClockWise:
-		/* DC-Motor Mode --> ClockWise Rotation (IN1 = 0, IN2 = 1) */
-		HAL_GPIO_WritePin(MOTOR_GPIO_PORT, MOTOR_IN1_PIN_ID, GPIO_PIN_RESET);
-		HAL_GPIO_WritePin(MOTOR_GPIO_PORT, MOTOR_IN2_PIN_ID, GPIO_PIN_SET);
+	case BRAKE:
+		DcMotor_AbortRamp();
+		DcMotor_WriteDirection(BRAKE);
+		MOTOR_PWM_COMPARE_REG = DcMotor_PwmPeriod;    // Bridge enabled: terminals shorted
 		break;
+	case ClockWise:
 	case Anti_ClockWise:
-		/* DC-Motor Mode --> Anti_ClockWise Rotation (IN1 = 1, IN2 = 0) */
-		HAL_GPIO_WritePin(MOTOR_GPIO_PORT, MOTOR_IN1_PIN_ID, GPIO_PIN_SET);
-		HAL_GPIO_WritePin(MOTOR_GPIO_PORT, MOTOR_IN2_PIN_ID, GPIO_PIN_RESET);
+		if (state != previous) {
+			/* A reversal restarts from zero speed, through STOP for the dead-time */
+			DcMotor_AbortRamp();
+			MOTOR_PWM_COMPARE_REG = 0;
+			if ((previous == ClockWise) || (previous == Anti_ClockWise)) {
+				DcMotor_WriteDirection(STOP);
+				DcMotor_DeadTime();
+			}
+		}
+		DcMotor_WriteDirection(state);
 		break;
 	default:
-		break;
+		return;
 	}
+
+	DcMotor_TransitionCycles[state] = CycleCounter_Get() - start;
+	DcMotor_CurrentState = state;
+
+	if (state != previous)
+		DcMotor_StateCallback(state, DcMotor_SpeedPercent);
+
+	if ((state == ClockWise) || (state == Anti_ClockWise))
+		DcMotor_StartRamp(DcMotor_SpeedCompare, 0);
+}
+
+/*
+ Description:
+ Soft stop: ramp the duty cycle down to zero with the deceleration ramp, then stop the motor.
+
+ Return: None
+ */
+void DcMotor_Stop(void)
+{
+	if ((DcMotor_CurrentState != ClockWise) && (DcMotor_CurrentState != Anti_ClockWise)) {
+		DcMotor_Rotate(STOP);    // Release a brake
+		return;
+	}
+
+	DcMotor_StartRamp(0, 1);
+}
+
+/*
+ Description:
+ Set the motor speed. If the motor is running, the duty cycle ramps to the new value.
+
+ Inputs:
+ 1) duty: Duty cycle of EN1 in percent (0 - 100).
+
+ Return: None
+ */
+void DcMotor_SetSpeed(uint8_t duty)
+{
+	if (duty > 100U)
+		duty = 100U;
+
+	if (duty == DcMotor_SpeedPercent)
+		return;
+
+	DcMotor_SpeedPercent = duty;
+	DcMotor_SpeedCompare = (DcMotor_PwmPeriod * duty) / 100U;
+
+	/* Follow the new set point unless the motor is stopped, braking or stopping */
+	if (((DcMotor_CurrentState == ClockWise) || (DcMotor_CurrentState == Anti_ClockWise))
+			&& !DcMotor_StopAtRampEnd) {
+		DcMotor_StartRamp(DcMotor_SpeedCompare, 0);
+		DcMotor_StateCallback(DcMotor_CurrentState, duty);
+	}
+}
+
+/*
+ Description:
+ Configure the soft-start / soft-stop ramps.
+
+ Inputs:
+ 1) accelerationMs: Time of a 0 -> 100 % duty cycle ramp (0 = no ramp).
+ 2) decelerationMs: Time of a 100 -> 0 % duty cycle ramp (0 = no ramp).
+
+ Return: None
+ */
+void DcMotor_SetRamp(uint16_t accelerationMs, uint16_t decelerationMs)
+{
+	DcMotor_AccelerationMs = accelerationMs;
+	DcMotor_DecelerationMs = decelerationMs;
+}
+
+/*
+ Description:
+ Return the direction the motor is currently driven in.
+ */
+DcMotor_State DcMotor_GetState(void)
+{
+	return DcMotor_CurrentState;
+}
+
+/*
+ Description:
+ Cost of the last transition into a state, in CPU cycles.
+ */
+uint32_t DcMotor_GetTransitionCycles(DcMotor_State state)
+{
+	return (state < DCMOTOR_NUM_STATES)? DcMotor_TransitionCycles[state] : 0;
+}
+
+/*
+ Description:
+ Ramp DMA interrupt service, called from the MOTOR_RAMP_DMA_IRQn handler at the end of a ramp.
+ */
+void DcMotor_RampIRQHandler(void)
+{
+	uint8_t transferComplete = (__HAL_DMA_GET_FLAG(&DcMotor_RampDmaHandle,
+			__HAL_DMA_GET_TC_FLAG_INDEX(&DcMotor_RampDmaHandle)) != 0);
+
+	__HAL_DMA_CLEAR_FLAG(&DcMotor_RampDmaHandle,
+			__HAL_DMA_GET_TC_FLAG_INDEX(&DcMotor_RampDmaHandle) | __HAL_DMA_GET_HT_FLAG_INDEX(&DcMotor_RampDmaHandle)
+			| __HAL_DMA_GET_TE_FLAG_INDEX(&DcMotor_RampDmaHandle) | __HAL_DMA_GET_DME_FLAG_INDEX(&DcMotor_RampDmaHandle)
+			| __HAL_DMA_GET_FE_FLAG_INDEX(&DcMotor_RampDmaHandle));
+
+	if (transferComplete) {
+		MOTOR_RAMP_TIMER->CR1 &= ~TIM_CR1_CEN;
+		DcMotor_RampEnd();
+	}
+}
+
+/*
+ Description:
+ State change notification. Weak: override it in the application.
+ */
+__weak void DcMotor_StateCallback(DcMotor_State state, uint8_t speed)
+{
+	UNUSED(state);
+	UNUSED(speed);
 }
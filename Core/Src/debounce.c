@@ -0,0 +1,383 @@
+/******************************************************************************
+ *
+ * Module: DEBOUNCE
+ *
+ * File Name: debounce.c
+ *
+ * Description: Source file for the bit-parallel (vertical counter) input debouncer.
+ *
+ *   Every tracked pin owns one bit in each of three words: the debounced state and
+ *   the two bits of a 2-bit counter (cnt1:cnt0). Each sample is compared with the
+ *   debounced state; the counter of a differing pin counts up, the counter of a
+ *   matching pin is cleared. When a counter wraps after DEBOUNCE_SAMPLES_NUM
+ *   differing samples the state bit toggles. All pins advance with a handful of
+ *   bitwise operations, whatever their number.
+ *
+ *   With DMA sampling the ports are read by the DMA and a block of raw samples
+ *   is reduced to one sample per pin (changed only if the whole block agrees)
+ *   before the same counter step: the CPU cost per block does not depend on
+ *   the number of pins either.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#include "debounce.h"
+#include "main.h"          // Error_Handler()
+#include "cycle_counter.h"
+#include "timer_clock.h"
+
+/*******************************************************************************
+ *                           Private Variables                                 *
+ *******************************************************************************/
+
+#if (DEBOUNCE_SAMPLING == DEBOUNCE_SAMPLING_TIMER_IRQ)
+static TIM_HandleTypeDef Debounce_TimerHandle;
+#endif
+
+static uint32_t Debounce_PinMask;             // Pins handled by the service
+static volatile uint32_t Debounce_State;      // Debounced state (1 = pressed)
+static uint32_t Debounce_Cnt0;                // Vertical counter, bit 0
+static uint32_t Debounce_Cnt1;                // Vertical counter, bit 1
+
+static volatile uint32_t Debounce_PressedEdges;   // Accumulated until Debounce_GetEdges()
+static volatile uint32_t Debounce_ReleasedEdges;
+
+#if (DEBOUNCE_SAMPLING == DEBOUNCE_SAMPLING_DMA)
+static TIM_HandleTypeDef Debounce_DmaTimerHandle;
+static DMA_HandleTypeDef Debounce_DmaPortBHandle;
+static DMA_HandleTypeDef Debounce_DmaPortDHandle;
+
+/* Raw IDR samples, two blocks each: one is processed while the DMA fills the other */
+static volatile uint32_t Debounce_PortBSamples[2U * DEBOUNCE_DMA_BLOCK_SAMPLES];
+static volatile uint32_t Debounce_PortDSamples[2U * DEBOUNCE_DMA_BLOCK_SAMPLES];
+
+static volatile uint32_t Debounce_BlockCycles;
+#endif
+
+/*******************************************************************************
+ *                           Private Functions                                 *
+ *******************************************************************************/
+
+/* Read both ports at once and return the "pressed" level of every tracked pin */
+static inline uint32_t Debounce_Sample(void)
+{
+    uint32_t levels = (GPIOB->IDR << DEBOUNCE_PORTB_SHIFT) | (GPIOD->IDR << DEBOUNCE_PORTD_SHIFT);
+
+    return (~levels & Debounce_PinMask);    // Inputs are pulled up: low level = pressed
+}
+
+/*
+ * One debounce step on a sample of every tracked pin (1 = pressed): advance the vertical
+ * counters, report the accepted edges. Returns 1 once every pin has settled.
+ */
+static uint8_t Debounce_Step(uint32_t sample)
+{
+    uint32_t delta;
+    uint32_t toggle;
+
+    delta = sample ^ Debounce_State;
+
+    /* 2-bit vertical counter: counts differing samples, cleared by matching ones */
+    Debounce_Cnt1 = (Debounce_Cnt1 ^ Debounce_Cnt0) & delta;
+    Debounce_Cnt0 = ~Debounce_Cnt0 & delta;
+
+    /* Counter wrapped to zero while still differing: accept the new level */
+    toggle = delta & ~(Debounce_Cnt0 | Debounce_Cnt1);
+
+    if (toggle)
+    {
+        uint32_t state = Debounce_State ^ toggle;
+
+        Debounce_State = state;
+        Debounce_PressedEdges |= toggle & state;
+        Debounce_ReleasedEdges |= toggle & ~state;
+
+        Debounce_EdgeCallback(toggle & state, toggle & ~state);
+    }
+
+    return ((Debounce_Cnt0 | Debounce_Cnt1) == 0);
+}
+
+#if (DEBOUNCE_SAMPLING == DEBOUNCE_SAMPLING_DMA)
+/* Reduce one block of raw samples of both ports to one debounce step */
+static void Debounce_ProcessBlock(uint32_t first)
+{
+    uint32_t start = CycleCounter_Get();
+    uint32_t allPressed = Debounce_PinMask;
+    uint32_t anyPressed = 0;
+    uint32_t pressed;
+    uint32_t i;
+
+    for (i = first; i < (first + DEBOUNCE_DMA_BLOCK_SAMPLES); i++)
+    {
+        pressed = ~(((Debounce_PortBSamples[i] & 0xFFFFU) << DEBOUNCE_PORTB_SHIFT)
+                  | ((Debounce_PortDSamples[i] & 0xFFFFU) << DEBOUNCE_PORTD_SHIFT)) & Debounce_PinMask;
+        allPressed &= pressed;
+        anyPressed |= pressed;
+    }
+
+    /* A pin changes only if the whole block agrees: shorter glitches keep the current state */
+    Debounce_Step((Debounce_State | allPressed) & anyPressed);
+
+    Debounce_BlockCycles = CycleCounter_Get() - start;
+}
+
+static void Debounce_HalfTransfer(DMA_HandleTypeDef *hdma)
+{
+    UNUSED(hdma);
+    Debounce_ProcessBlock(0);
+}
+
+static void Debounce_FullTransfer(DMA_HandleTypeDef *hdma)
+{
+    UNUSED(hdma);
+    Debounce_ProcessBlock(DEBOUNCE_DMA_BLOCK_SAMPLES);
+}
+
+/* One DMA stream: IDR of a port -> its sample buffer, circular, on a TIM8 request */
+static void Debounce_DmaStreamInit(DMA_HandleTypeDef *hdma, DMA_Stream_TypeDef *stream, uint32_t channel)
+{
+    hdma->Instance = stream;
+    hdma->Init.Channel = channel;
+    hdma->Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma->Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma->Init.MemInc = DMA_MINC_ENABLE;
+    hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+    hdma->Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+    hdma->Init.Mode = DMA_CIRCULAR;
+    hdma->Init.Priority = DMA_PRIORITY_LOW;
+    hdma->Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+
+    if (HAL_DMA_Init(hdma) != HAL_OK)
+    {
+        Error_Handler();
+    }
+}
+
+/* Start the sampling timer and both DMA streams */
+static void Debounce_DmaInit(void)
+{
+    __DEBOUNCE_DMA_CLK_ENABLE();
+    __DEBOUNCE_DMA_TIMER_CLK_ENABLE();
+
+    Debounce_DmaStreamInit(&Debounce_DmaPortBHandle, DEBOUNCE_DMA_PORTB_STREAM, DEBOUNCE_DMA_PORTB_CHANNEL);
+    Debounce_DmaStreamInit(&Debounce_DmaPortDHandle, DEBOUNCE_DMA_PORTD_STREAM, DEBOUNCE_DMA_PORTD_CHANNEL);
+
+    /* GPIOD is sampled last in every period: its half/full transfer means both blocks are complete */
+    Debounce_DmaPortDHandle.XferHalfCpltCallback = Debounce_HalfTransfer;
+    Debounce_DmaPortDHandle.XferCpltCallback = Debounce_FullTransfer;
+
+    /* Same priority as the button EXTI lines */
+    HAL_NVIC_SetPriority(DEBOUNCE_DMA_IRQn, 8, 0);
+    HAL_NVIC_EnableIRQ(DEBOUNCE_DMA_IRQn);
+
+    if ((HAL_DMA_Start(&Debounce_DmaPortBHandle, (uint32_t)&GPIOB->IDR, (uint32_t)Debounce_PortBSamples,
+            2U * DEBOUNCE_DMA_BLOCK_SAMPLES) != HAL_OK)
+        || (HAL_DMA_Start_IT(&Debounce_DmaPortDHandle, (uint32_t)&GPIOD->IDR, (uint32_t)Debounce_PortDSamples,
+            2U * DEBOUNCE_DMA_BLOCK_SAMPLES) != HAL_OK))
+    {
+        Error_Handler();
+    }
+
+    /* Timer counts microseconds: update request at the start of a period, CC1 request in the middle */
+    Debounce_DmaTimerHandle.Instance = DEBOUNCE_DMA_TIMER;
+    Debounce_DmaTimerHandle.Init.Prescaler = (TimerClock_GetFrequency(DEBOUNCE_DMA_TIMER) / 1000000U) - 1U;
+    Debounce_DmaTimerHandle.Init.CounterMode = TIM_COUNTERMODE_UP;
+    Debounce_DmaTimerHandle.Init.Period = (1000000U / DEBOUNCE_DMA_RATE_HZ) - 1U;
+    Debounce_DmaTimerHandle.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    Debounce_DmaTimerHandle.Init.RepetitionCounter = 0;
+    Debounce_DmaTimerHandle.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+
+    if (HAL_TIM_Base_Init(&Debounce_DmaTimerHandle) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    /* CC1 left in frozen mode (no output): the compare match only raises the DMA request */
+    DEBOUNCE_DMA_TIMER->CCR1 = (1000000U / DEBOUNCE_DMA_RATE_HZ) / 2U;
+    __HAL_TIM_ENABLE_DMA(&Debounce_DmaTimerHandle, TIM_DMA_UPDATE | TIM_DMA_CC1);
+    __HAL_TIM_ENABLE(&Debounce_DmaTimerHandle);
+}
+#endif
+
+/*******************************************************************************
+ *                           Functions Definitions                             *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize the debounce service.
+ *
+ * Parameters:
+ * - pinMask: DEBOUNCE_MASK() of every pin that has to be debounced.
+ *
+ * Return:
+ * - None
+ */
+void Debounce_Init(uint32_t pinMask)
+{
+    Debounce_PinMask = pinMask;
+    Debounce_Cnt0 = 0;
+    Debounce_Cnt1 = 0;
+    Debounce_PressedEdges = 0;
+    Debounce_ReleasedEdges = 0;
+    Debounce_State = Debounce_Sample();
+
+#if (DEBOUNCE_SAMPLING == DEBOUNCE_SAMPLING_DMA)
+    Debounce_DmaInit();
+#else
+    /* Timer counts microseconds and overflows once per sample period */
+    Debounce_TimerHandle.Instance = DEBOUNCE_TIMER;
+    Debounce_TimerHandle.Init.Prescaler = (TimerClock_GetFrequency(DEBOUNCE_TIMER) / 1000000U) - 1U;
+    Debounce_TimerHandle.Init.CounterMode = TIM_COUNTERMODE_UP;
+    Debounce_TimerHandle.Init.Period = DEBOUNCE_SAMPLE_PERIOD_US - 1U;
+    Debounce_TimerHandle.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    Debounce_TimerHandle.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+
+    if (HAL_TIM_Base_Init(&Debounce_TimerHandle) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    __HAL_TIM_CLEAR_FLAG(&Debounce_TimerHandle, TIM_FLAG_UPDATE);
+    __HAL_TIM_ENABLE_IT(&Debounce_TimerHandle, TIM_IT_UPDATE);
+#endif
+}
+
+/*
+ * Description :
+ * Start sampling (if not already running).
+ *
+ * Return:
+ * - uint8_t: 1 if this call started a new sampling burst, 0 if it was already running.
+ */
+uint8_t Debounce_Start(void)
+{
+#if (DEBOUNCE_SAMPLING == DEBOUNCE_SAMPLING_DMA)
+    /* Always sampling: a new burst is an edge while every pin is settled */
+    return ((Debounce_Cnt0 | Debounce_Cnt1) == 0);
+#else
+    if (DEBOUNCE_TIMER->CR1 & TIM_CR1_CEN)
+        return 0;
+
+    /* First sample one full period after the edge that woke us up */
+    DEBOUNCE_TIMER->CNT = 0;
+    __HAL_TIM_ENABLE(&Debounce_TimerHandle);
+
+    return 1;
+#endif
+}
+
+/*
+ * Description :
+ * Timer interrupt service of the debounce service.
+ *
+ * Return:
+ * - None
+ */
+void Debounce_IRQHandler(void)
+{
+#if (DEBOUNCE_SAMPLING == DEBOUNCE_SAMPLING_TIMER_IRQ)
+    if (!__HAL_TIM_GET_FLAG(&Debounce_TimerHandle, TIM_FLAG_UPDATE))
+        return;
+
+    __HAL_TIM_CLEAR_FLAG(&Debounce_TimerHandle, TIM_FLAG_UPDATE);
+
+    /* Everything settled: stop sampling until the next EXTI edge */
+    if (Debounce_Step(Debounce_Sample()))
+    {
+        __HAL_TIM_DISABLE(&Debounce_TimerHandle);
+    }
+#endif
+}
+
+/*
+ * Description :
+ * DMA interrupt service (DMA sampling): one block per half/full transfer.
+ *
+ * Return:
+ * - None
+ */
+void Debounce_DmaIRQHandler(void)
+{
+#if (DEBOUNCE_SAMPLING == DEBOUNCE_SAMPLING_DMA)
+    HAL_DMA_IRQHandler(&Debounce_DmaPortDHandle);
+#endif
+}
+
+/*
+ * Description :
+ * Cost of the last block processing in CPU cycles (0 without DMA sampling).
+ */
+uint32_t Debounce_GetBlockCycles(void)
+{
+#if (DEBOUNCE_SAMPLING == DEBOUNCE_SAMPLING_DMA)
+    return Debounce_BlockCycles;
+#else
+    return 0;
+#endif
+}
+
+/*
+ * Description :
+ * Return the debounced state of all tracked pins (set bit = pressed).
+ */
+uint32_t Debounce_GetState(void)
+{
+    return Debounce_State;
+}
+
+/*
+ * Description :
+ * Return and clear the edges accumulated since the previous call.
+ *
+ * Parameters:
+ * - pressed: Receives the mask of pins that became pressed (may be NULL).
+ * - released: Receives the mask of pins that became released (may be NULL).
+ *
+ * Return:
+ * - None
+ */
+void Debounce_GetEdges(uint32_t *pressed, uint32_t *released)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+
+    if (pressed != NULL)
+        *pressed = Debounce_PressedEdges;
+    if (released != NULL)
+        *released = Debounce_ReleasedEdges;
+
+    Debounce_PressedEdges = 0;
+    Debounce_ReleasedEdges = 0;
+
+    __set_PRIMASK(primask);
+}
+
+/*
+ * Description :
+ * Check the debounced state of a single pin.
+ *
+ * Parameters:
+ * - GPIOx: GPIOB or GPIOD.
+ * - pin: GPIO_PIN_x of the input.
+ *
+ * Return:
+ * - uint8_t: 1 if the pin is (debounced) pressed, 0 otherwise.
+ */
+uint8_t Debounce_IsPressed(GPIO_TypeDef *GPIOx, uint16_t pin)
+{
+    return ((Debounce_State & DEBOUNCE_MASK(GPIOx, pin)) != 0);
+}
+
+/*
+ * Description :
+ * Edge notification, called from the timer interrupt. Default: nothing to do.
+ */
+__weak void Debounce_EdgeCallback(uint32_t pressed, uint32_t released)
+{
+    UNUSED(pressed);
+    UNUSED(released);
+}
@@ -0,0 +1,93 @@
+/******************************************************************************
+ *
+ * Module: ENCODER
+ *
+ * File Name: encoder.c
+ *
+ * Description: Source file for the quadrature encoder driver (timer encoder interface,
+ *              the position is counted in hardware without any per-edge interrupt).
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#include "encoder.h"
+#include "main.h"          // Error_Handler()
+
+static TIM_HandleTypeDef Encoder_Handle;
+
+/*******************************************************************************
+ *                           Functions Definitions                             *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Configure the encoder pins and the timer in encoder mode, and start counting from zero.
+ *
+ * Return:
+ * - None
+ */
+void Encoder_Init(void)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = { 0 };
+    TIM_Encoder_InitTypeDef sConfig = { 0 };
+
+    __ENCODER_PORT_CLK_ENABLE();
+    __ENCODER_TIMER_CLK_ENABLE();
+
+    GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+    GPIO_InitStruct.Pull = GPIO_PULLUP;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+    GPIO_InitStruct.Alternate = ENCODER_PIN_AF;
+
+    GPIO_InitStruct.Pin = ENCODER_A_PIN_ID;
+    HAL_GPIO_Init(ENCODER_A_GPIO_PORT, &GPIO_InitStruct);
+
+    GPIO_InitStruct.Pin = ENCODER_B_PIN_ID;
+    HAL_GPIO_Init(ENCODER_B_GPIO_PORT, &GPIO_InitStruct);
+
+    Encoder_Handle.Instance = ENCODER_TIMER;
+    Encoder_Handle.Init.Prescaler = 0;
+    Encoder_Handle.Init.CounterMode = TIM_COUNTERMODE_UP;
+    Encoder_Handle.Init.Period = 0xFFFFFFFFU;
+    Encoder_Handle.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    Encoder_Handle.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+
+    /* Count on both edges of both channels (x4), filtered against contact noise */
+    sConfig.EncoderMode = TIM_ENCODERMODE_TI12;
+    sConfig.IC1Polarity = TIM_ICPOLARITY_RISING;
+    sConfig.IC1Selection = TIM_ICSELECTION_DIRECTTI;
+    sConfig.IC1Prescaler = TIM_ICPSC_DIV1;
+    sConfig.IC1Filter = ENCODER_INPUT_FILTER;
+    sConfig.IC2Polarity = TIM_ICPOLARITY_RISING;
+    sConfig.IC2Selection = TIM_ICSELECTION_DIRECTTI;
+    sConfig.IC2Prescaler = TIM_ICPSC_DIV1;
+    sConfig.IC2Filter = ENCODER_INPUT_FILTER;
+
+    if (HAL_TIM_Encoder_Init(&Encoder_Handle, &sConfig) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    ENCODER_TIMER->CNT = 0;
+
+    if (HAL_TIM_Encoder_Start(&Encoder_Handle, TIM_CHANNEL_ALL) != HAL_OK)
+    {
+        Error_Handler();
+    }
+}
+
+/*
+ * Description :
+ * Overwrite the hardware count.
+ *
+ * Parameters:
+ * - count: New count.
+ *
+ * Return:
+ * - None
+ */
+void Encoder_SetCount(int32_t count)
+{
+    ENCODER_TIMER->CNT = (uint32_t)count;
+}
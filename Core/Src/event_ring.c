@@ -0,0 +1,85 @@
+/******************************************************************************
+ *
+ * Module: EVENT RING
+ *
+ * File Name: event_ring.c
+ *
+ * Description: Source file for the lock-free SPSC ring of timestamped input events.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#include "event_ring.h"
+
+/*******************************************************************************
+ *                           Functions Definitions                             *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize an empty ring (before its producer interrupt is enabled).
+ *
+ * Parameters:
+ * - ring: Pointer to the ring instance.
+ * - buffer: Event storage.
+ * - size: Number of events of the storage, a power of two.
+ *
+ * Return:
+ * - None
+ */
+void EventRing_Init(EventRing_TypeDef *ring, EventRing_EventTypeDef *buffer, uint32_t size)
+{
+    if ((ring == NULL) || (buffer == NULL) || (size == 0) || ((size & (size - 1U)) != 0))
+        return;
+
+    ring->buffer = buffer;
+    ring->mask = size - 1U;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->dropped = 0;
+}
+
+/*
+ * Description :
+ * Return the oldest unread event without releasing it.
+ *
+ * Parameters:
+ * - ring: Pointer to the ring instance.
+ *
+ * Return:
+ * - const EventRing_EventTypeDef *: NULL if the ring is empty.
+ */
+const EventRing_EventTypeDef *EventRing_Peek(EventRing_TypeDef *ring)
+{
+    uint32_t tail = ring->tail;
+
+    if (ring->head == tail)
+        return NULL;
+
+    /* Read the event only after the head that published it */
+    __DMB();
+    return &ring->buffer[tail & ring->mask];
+}
+
+/*
+ * Description :
+ * Release the oldest event, its slot can be reused by the producer.
+ *
+ * Parameters:
+ * - ring: Pointer to the ring instance.
+ *
+ * Return:
+ * - None
+ */
+void EventRing_Pop(EventRing_TypeDef *ring)
+{
+    uint32_t tail = ring->tail;
+
+    if (ring->head == tail)
+        return;
+
+    /* Done with the slot before the producer can see it free */
+    __DMB();
+    ring->tail = tail + 1U;
+}
@@ -0,0 +1,167 @@
+/******************************************************************************
+ *
+ * Module: EXTI DISPATCH
+ *
+ * File Name: exti_dispatch.c
+ *
+ * Description: Source file for the EXTI dispatcher.
+ *
+ *   HAL_GPIO_EXTI_IRQHandler() reads and clears one pin per call and ends in a
+ *   single HAL_GPIO_EXTI_Callback() that has to compare the pin again. Here the
+ *   pending register is read once per interrupt, the pending lines of the vector
+ *   are found with CLZ (one instruction per line, whatever the line number) and
+ *   each costs one indirect call through the table.
+ *
+ *   Every edge is also logged with the cycle count of the interrupt entry into
+ *   the SPSC ring of its vector. The consumer merges the rings by timestamp,
+ *   which restores the order of edges served by different (nested) vectors.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#include "exti_dispatch.h"
+#include "cycle_counter.h"
+
+/*******************************************************************************
+ *                           Private Variables                                 *
+ *******************************************************************************/
+
+static const ExtiDispatch_EntryTypeDef *ExtiDispatch_Table;
+
+static const uint32_t ExtiDispatch_VectorLines[EXTI_DISPATCH_NUM_VECTORS] = {
+    [EXTI_DISPATCH_VECTOR_0]     = EXTI_DISPATCH_LINE(0),
+    [EXTI_DISPATCH_VECTOR_1]     = EXTI_DISPATCH_LINE(1),
+    [EXTI_DISPATCH_VECTOR_2]     = EXTI_DISPATCH_LINE(2),
+    [EXTI_DISPATCH_VECTOR_3]     = EXTI_DISPATCH_LINE(3),
+    [EXTI_DISPATCH_VECTOR_4]     = EXTI_DISPATCH_LINE(4),
+    [EXTI_DISPATCH_VECTOR_9_5]   = 0x000003E0UL,
+    [EXTI_DISPATCH_VECTOR_15_10] = 0x0000FC00UL,
+};
+
+static EventRing_TypeDef ExtiDispatch_Log[EXTI_DISPATCH_NUM_VECTORS];
+static EventRing_EventTypeDef ExtiDispatch_LogBuffer[EXTI_DISPATCH_NUM_VECTORS][EXTI_DISPATCH_LOG_SIZE];
+
+/*******************************************************************************
+ *                           Private Functions                                 *
+ *******************************************************************************/
+
+/* Level of the pin routed to a line: the port is the SYSCFG EXTICR selection */
+static inline uint8_t ExtiDispatch_LineLevel(uint32_t line)
+{
+    uint32_t port = (SYSCFG->EXTICR[line >> 2U] >> ((line & 3U) * 4U)) & 0x0FU;
+    GPIO_TypeDef *gpio = (GPIO_TypeDef *)(GPIOA_BASE + (port * (GPIOB_BASE - GPIOA_BASE)));
+
+    return (uint8_t)((gpio->IDR >> line) & 1U);
+}
+
+/*******************************************************************************
+ *                           Functions Definitions                             *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Register the handler table (EXTI_DISPATCH_NUM_LINES entries indexed by line).
+ */
+void ExtiDispatch_Register(const ExtiDispatch_EntryTypeDef *table)
+{
+    uint32_t vector;
+
+    for (vector = 0; vector < EXTI_DISPATCH_NUM_VECTORS; vector++)
+        EventRing_Init(&ExtiDispatch_Log[vector], ExtiDispatch_LogBuffer[vector], EXTI_DISPATCH_LOG_SIZE);
+
+    ExtiDispatch_Table = table;
+}
+
+/*
+ * Description :
+ * Serve the pending lines of one EXTI vector.
+ *
+ * Parameters:
+ * - vector: The calling vector.
+ *
+ * Return:
+ * - None
+ */
+void ExtiDispatch_IRQHandler(ExtiDispatch_Vector_e vector)
+{
+    uint32_t timestamp = CycleCounter_Get();
+    const ExtiDispatch_EntryTypeDef *table = ExtiDispatch_Table;
+    uint32_t pending = EXTI->PR & ExtiDispatch_VectorLines[vector];
+    uint32_t line;
+
+    /* Write-1-to-clear before the handlers: an edge during a handler pends the vector again */
+    EXTI->PR = pending;
+
+    if (table == NULL)
+        return;
+
+    while (pending != 0)
+    {
+        line = 31U - __CLZ(pending);
+        pending &= ~EXTI_DISPATCH_LINE(line);
+
+        EventRing_Push(&ExtiDispatch_Log[vector], timestamp, (uint8_t)line, ExtiDispatch_LineLevel(line));
+
+        if (table[line].handler != NULL)
+            table[line].handler(table[line].context);
+    }
+}
+
+/*
+ * Description :
+ * Move up to maxEvents logged edges into events, oldest first (single consumer task).
+ *
+ * Parameters:
+ * - events: Destination of the batch.
+ * - maxEvents: Batch size.
+ *
+ * Return:
+ * - uint32_t: Number of events returned.
+ */
+uint32_t ExtiDispatch_ReadEvents(EventRing_EventTypeDef *events, uint32_t maxEvents)
+{
+    const EventRing_EventTypeDef *oldest;
+    const EventRing_EventTypeDef *event;
+    uint32_t oldestVector = 0;
+    uint32_t count = 0;
+    uint32_t vector;
+
+    while (count < maxEvents)
+    {
+        /* Head of every ring: keep the oldest (signed difference, valid across a CYCCNT wrap) */
+        oldest = NULL;
+        for (vector = 0; vector < EXTI_DISPATCH_NUM_VECTORS; vector++)
+        {
+            event = EventRing_Peek(&ExtiDispatch_Log[vector]);
+            if ((event != NULL) && ((oldest == NULL) || ((int32_t)(event->timestamp - oldest->timestamp) < 0)))
+            {
+                oldest = event;
+                oldestVector = vector;
+            }
+        }
+
+        if (oldest == NULL)
+            break;
+
+        events[count++] = *oldest;
+        EventRing_Pop(&ExtiDispatch_Log[oldestVector]);
+    }
+
+    return count;
+}
+
+/*
+ * Description :
+ * Return the number of edges lost on a full log.
+ */
+uint32_t ExtiDispatch_GetDroppedEvents(void)
+{
+    uint32_t dropped = 0;
+    uint32_t vector;
+
+    for (vector = 0; vector < EXTI_DISPATCH_NUM_VECTORS; vector++)
+        dropped += ExtiDispatch_Log[vector].dropped;
+
+    return dropped;
+}
@@ -24,6 +24,7 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "cycle_counter.h"
 
 /* USER CODE END Includes */
 
@@ -49,6 +50,8 @@
 
 /* Private function prototypes -----------------------------------------------*/
 /* USER CODE BEGIN FunctionPrototypes */
+void configureTimerForRunTimeStats(void);
+unsigned long getRunTimeCounterValue(void);
 
 /* USER CODE END FunctionPrototypes */
 
@@ -68,7 +71,79 @@ void vApplicationGetIdleTaskMemory( StaticTask_t **ppxIdleTaskTCBBuffer, StackTy
 }
 /* USER CODE END GET_IDLE_TASK_MEMORY */
 
+/* GetTimerTaskMemory prototype (linked to static allocation support) */
+void vApplicationGetTimerTaskMemory( StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer, uint32_t *pulTimerTaskStackSize );
+
+/* USER CODE BEGIN GET_TIMER_TASK_MEMORY */
+static StaticTask_t xTimerTaskTCBBuffer;
+static StackType_t xTimerStack[configTIMER_TASK_STACK_DEPTH];
+
+void vApplicationGetTimerTaskMemory( StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer, uint32_t *pulTimerTaskStackSize )
+{
+  *ppxTimerTaskTCBBuffer = &xTimerTaskTCBBuffer;
+  *ppxTimerTaskStackBuffer = &xTimerStack[0];
+  *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+  /* place for user code */
+}
+/* USER CODE END GET_TIMER_TASK_MEMORY */
+
 /* Private application code --------------------------------------------------*/
 /* USER CODE BEGIN Application */
 
+/* Run time statistics time base: the DWT cycle counter, started by CycleCounter_Init() in main()
+   (not restarted here: timestamps taken before the scheduler start stay valid) */
+void configureTimerForRunTimeStats(void)
+{
+}
+
+unsigned long getRunTimeCounterValue(void)
+{
+  return CycleCounter_Get();
+}
+
+/**
+  * @brief RTOS-aware HAL_Delay (overrides the weak HAL one).
+  *        Once the scheduler runs, a task calling it blocks with vTaskDelay() and the CPU
+  *        goes to the other tasks; before osKernelStart(), or with the scheduler suspended
+  *        (vTaskDelay() is not allowed there), it spins on the HAL tick like the HAL version.
+  *        Both wait at least Delay ms.
+  * @note  Must not be called from a critical section, with interrupts masked or from an
+  *        interrupt handler: SysTick, which advances the HAL tick, has the lowest priority
+  *        and stays pending there, so the spin would never end. Asserted below.
+  * @param Delay specifies the delay time length, in milliseconds.
+  * @retval None
+  */
+void HAL_Delay(uint32_t Delay)
+{
+  uint32_t tickstart;
+  uint32_t wait = Delay;
+  BaseType_t scheduler = xTaskGetSchedulerState();
+
+  /* The HAL tick is frozen in a critical section (BASEPRI), with PRIMASK set, or in a handler */
+  configASSERT((__get_PRIMASK() == 0U) && (__get_BASEPRI() == 0U) && (__get_IPSR() == 0U));
+
+  if (scheduler == taskSCHEDULER_RUNNING)
+  {
+    TickType_t ticks = pdMS_TO_TICKS(Delay);
+
+    /* The current tick is already partly elapsed: one more, as the HAL does */
+    if (ticks < portMAX_DELAY)
+    {
+      ticks++;
+    }
+    vTaskDelay(ticks);
+    return;
+  }
+
+  /* Not started or suspended (vTaskSuspendAll() leaves SysTick running): spin on the HAL tick */
+  tickstart = HAL_GetTick();
+  if (wait < HAL_MAX_DELAY)
+  {
+    wait += (uint32_t)(uwTickFreq);
+  }
+  while ((HAL_GetTick() - tickstart) < wait)
+  {
+  }
+}
+
 /* USER CODE END Application */
@@ -0,0 +1,310 @@
+/******************************************************************************
+ *
+ * Module: FRICTION MAP
+ *
+ * File Name: friction_map.c
+ *
+ * Description: Source file for the learned per-position friction profile.
+ *
+ *   The motor current needed to close the window depends on the position
+ *   (seals, guide rails). Every clean close records the peak block current
+ *   of each position bin, and the profile follows these peaks with an
+ *   exponential moving average. The pinch threshold of every bin is kept
+ *   precomputed in RAM so the detection path does a single lookup.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#include "friction_map.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define FRICTION_MAP_MAGIC           (0x464D4150UL)   /* "FMAP" */
+#define FRICTION_MAP_MAX_THRESHOLD   (0x0FFFU)        /* 12-bit ADC full scale */
+
+typedef enum
+{
+    FRICTION_RUN_IDLE, FRICTION_RUN_RECORDING, FRICTION_RUN_COMPLETE
+} FrictionMap_RunState_e;
+
+typedef enum
+{
+    FRICTION_SAVE_IDLE, FRICTION_SAVE_ERASING
+} FrictionMap_SaveState_e;
+
+/* Flash copy of the map, programmed word by word */
+typedef struct
+{
+    uint32_t magic;
+    uint16_t profile[FRICTION_MAP_BINS];
+    uint8_t runs[FRICTION_MAP_BINS];
+    uint32_t checksum;
+} FrictionMap_RecordTypeDef;
+
+#define FRICTION_MAP_RECORD_WORDS    (sizeof(FrictionMap_RecordTypeDef) / sizeof(uint32_t))
+
+/*******************************************************************************
+ *                           Private Variables                                 *
+ *******************************************************************************/
+
+static const FrictionMap_ConfigTypeDef *FrictionMap_Config;
+
+static uint16_t FrictionMap_Profile[FRICTION_MAP_BINS];            // Learned peak current per bin, in ADC counts
+static uint8_t FrictionMap_Runs[FRICTION_MAP_BINS];                // Clean closes learned per bin (saturated)
+static volatile uint16_t FrictionMap_Threshold[FRICTION_MAP_BINS]; // Pinch threshold lookup table
+
+static uint16_t FrictionMap_RunPeak[FRICTION_MAP_BINS];            // Peak current of the current run (0 = bin not seen)
+static volatile FrictionMap_RunState_e FrictionMap_RunState;
+
+static uint8_t FrictionMap_Dirty;
+static FrictionMap_SaveState_e FrictionMap_SaveState;
+static uint32_t FrictionMap_SaveTick;
+static FrictionMap_RecordTypeDef FrictionMap_Record;
+
+/*******************************************************************************
+ *                           Private Functions                                 *
+ *******************************************************************************/
+
+static inline uint32_t FrictionMap_Bin(uint16_t position)
+{
+    return ((uint32_t)((position > 1000U)? 1000U : position) * FRICTION_MAP_BINS) / 1001U;
+}
+
+static void FrictionMap_UpdateThreshold(uint32_t bin)
+{
+    uint32_t threshold = FrictionMap_Config->defaultThreshold;
+
+    if (FrictionMap_Runs[bin] >= FrictionMap_Config->minimumRuns)
+    {
+        threshold = (uint32_t)FrictionMap_Profile[bin] + FrictionMap_Config->margin;
+        if (threshold > FRICTION_MAP_MAX_THRESHOLD)
+            threshold = FRICTION_MAP_MAX_THRESHOLD;
+    }
+
+    FrictionMap_Threshold[bin] = (uint16_t)threshold;
+}
+
+static uint32_t FrictionMap_Checksum(const FrictionMap_RecordTypeDef *record)
+{
+    const uint32_t *word = (const uint32_t *)record;
+    uint32_t sum = 0;
+    uint32_t i;
+
+    for (i = 0; i < (FRICTION_MAP_RECORD_WORDS - 1U); i++)
+        sum += word[i];
+
+    return ~sum;
+}
+
+/* Merge the peaks of a clean run into the profile */
+static void FrictionMap_Merge(void)
+{
+    uint32_t bin;
+    int32_t profile;
+
+    for (bin = 0; bin < FRICTION_MAP_BINS; bin++)
+    {
+        if (FrictionMap_RunPeak[bin] == 0)
+            continue;
+
+        if (FrictionMap_Runs[bin] == 0)
+        {
+            FrictionMap_Profile[bin] = FrictionMap_RunPeak[bin];
+        }
+        else
+        {
+            profile = FrictionMap_Profile[bin];
+            profile += ((int32_t)FrictionMap_RunPeak[bin] - profile) >> FrictionMap_Config->learnShift;
+            FrictionMap_Profile[bin] = (uint16_t)profile;
+        }
+
+        if (FrictionMap_Runs[bin] < UINT8_MAX)
+            FrictionMap_Runs[bin]++;
+
+        FrictionMap_UpdateThreshold(bin);
+    }
+
+    FrictionMap_Dirty = 1;
+}
+
+/* Program the snapshot into the erased sector */
+static void FrictionMap_Program(void)
+{
+    const uint32_t *word = (const uint32_t *)&FrictionMap_Record;
+    uint32_t i;
+
+    for (i = 0; i < FRICTION_MAP_RECORD_WORDS; i++)
+    {
+        if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, FRICTION_MAP_FLASH_ADDRESS + (4U * i), word[i]) != HAL_OK)
+        {
+            FrictionMap_Dirty = 1;   // Retry at the next save interval
+            break;
+        }
+    }
+}
+
+/*******************************************************************************
+ *                           Functions Definitions                             *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize the map from its flash copy and build the threshold lookup table.
+ *
+ * Parameters:
+ * - config: Pointer to the map settings (kept by reference).
+ *
+ * Return:
+ * - None
+ */
+void FrictionMap_Init(const FrictionMap_ConfigTypeDef *config)
+{
+    const FrictionMap_RecordTypeDef *stored = (const FrictionMap_RecordTypeDef *)FRICTION_MAP_FLASH_ADDRESS;
+    uint8_t valid = (stored->magic == FRICTION_MAP_MAGIC) && (stored->checksum == FrictionMap_Checksum(stored));
+    uint32_t bin;
+
+    FrictionMap_Config = config;
+    FrictionMap_RunState = FRICTION_RUN_IDLE;
+    FrictionMap_SaveState = FRICTION_SAVE_IDLE;
+    FrictionMap_Dirty = 0;
+    FrictionMap_SaveTick = HAL_GetTick();
+
+    for (bin = 0; bin < FRICTION_MAP_BINS; bin++)
+    {
+        FrictionMap_Profile[bin] = valid? stored->profile[bin] : 0U;
+        FrictionMap_Runs[bin] = valid? stored->runs[bin] : 0U;
+        FrictionMap_RunPeak[bin] = 0;
+        FrictionMap_UpdateThreshold(bin);
+    }
+}
+
+/*
+ * Description :
+ * Return the pinch threshold at a position.
+ *
+ * Parameters:
+ * - position: Window position in 0.1 % (0 .. 1000).
+ *
+ * Return:
+ * - uint16_t: Threshold in ADC counts.
+ */
+uint16_t FrictionMap_GetThreshold(uint16_t position)
+{
+    return FrictionMap_Threshold[FrictionMap_Bin(position)];
+}
+
+/*
+ * Description :
+ * Start recording a closing run.
+ */
+void FrictionMap_StartRun(void)
+{
+    uint32_t bin;
+
+    if ((FrictionMap_Config == NULL) || (FrictionMap_RunState != FRICTION_RUN_IDLE))
+        return;
+
+    for (bin = 0; bin < FRICTION_MAP_BINS; bin++)
+        FrictionMap_RunPeak[bin] = 0;
+
+    FrictionMap_RunState = FRICTION_RUN_RECORDING;
+}
+
+/*
+ * Description :
+ * Record the motor current of one block of the closing run.
+ *
+ * Parameters:
+ * - position: Window position in 0.1 % (0 .. 1000).
+ * - level: Block mean of the motor current, in ADC counts.
+ *
+ * Return:
+ * - None
+ */
+void FrictionMap_RecordLevel(uint16_t position, uint16_t level)
+{
+    uint32_t bin;
+
+    if (FrictionMap_RunState != FRICTION_RUN_RECORDING)
+        return;
+
+    bin = FrictionMap_Bin(position);
+    if (level > FrictionMap_RunPeak[bin])
+        FrictionMap_RunPeak[bin] = level;
+}
+
+/*
+ * Description :
+ * End the closing run, a clean run is kept for FrictionMap_Service().
+ *
+ * Parameters:
+ * - clean: 1 for a clean close.
+ *
+ * Return:
+ * - None
+ */
+void FrictionMap_EndRun(uint8_t clean)
+{
+    if (FrictionMap_RunState != FRICTION_RUN_RECORDING)
+        return;
+
+    FrictionMap_RunState = clean? FRICTION_RUN_COMPLETE : FRICTION_RUN_IDLE;
+}
+
+/*
+ * Description :
+ * Merge a clean run and write the map to flash at a low rate.
+ */
+void FrictionMap_Service(void)
+{
+    uint32_t bin;
+
+    if (FrictionMap_Config == NULL)
+        return;
+
+    if (FrictionMap_RunState == FRICTION_RUN_COMPLETE)
+    {
+        FrictionMap_Merge();
+        FrictionMap_RunState = FRICTION_RUN_IDLE;
+    }
+
+    if (FrictionMap_SaveState == FRICTION_SAVE_ERASING)
+    {
+        if (__HAL_FLASH_GET_FLAG(FLASH_FLAG_BSY))
+            return;    // A 128 KB sector erase takes about a second
+
+        CLEAR_BIT(FLASH->CR, (FLASH_CR_SER | FLASH_CR_SNB));
+        __HAL_FLASH_DATA_CACHE_DISABLE();
+        __HAL_FLASH_DATA_CACHE_RESET();
+        __HAL_FLASH_DATA_CACHE_ENABLE();
+
+        FrictionMap_Program();
+        HAL_FLASH_Lock();
+        FrictionMap_SaveState = FRICTION_SAVE_IDLE;
+        return;
+    }
+
+    if (!FrictionMap_Dirty || ((HAL_GetTick() - FrictionMap_SaveTick) < FrictionMap_Config->saveIntervalMs))
+        return;
+
+    /* Snapshot of the map, later runs are saved at the next interval */
+    FrictionMap_Record.magic = FRICTION_MAP_MAGIC;
+    for (bin = 0; bin < FRICTION_MAP_BINS; bin++)
+    {
+        FrictionMap_Record.profile[bin] = FrictionMap_Profile[bin];
+        FrictionMap_Record.runs[bin] = FrictionMap_Runs[bin];
+    }
+    FrictionMap_Record.checksum = FrictionMap_Checksum(&FrictionMap_Record);
+
+    FrictionMap_Dirty = 0;
+    FrictionMap_SaveTick = HAL_GetTick();
+
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR |
+                           FLASH_FLAG_PGAERR | FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR);
+    FLASH_Erase_Sector(FRICTION_MAP_FLASH_SECTOR, FLASH_VOLTAGE_RANGE_3);
+    FrictionMap_SaveState = FRICTION_SAVE_ERASING;
+}
@@ -11,6 +11,7 @@
  ******************************************************************************/
 
 #include "limit_switch.h"
+#include "cycle_counter.h"
 
 /*******************************************************************************
  *                           Functions Definitions                             *
@@ -116,3 +117,108 @@ LimitSwitchState_e LimitSwitch_GetState(LimitSwitch_TypeDef *limitSwitch)
 
     return currentState;
 }
+
+/*
+ * Description :
+ * Initialize the Limit Switch Pin as an external interrupt source.
+ *
+ * Parameters:
+ * - limitSwitch: A pointer to the LimitSwitch structure containing the port and pin information.
+ * - onTouched: Callback invoked from the interrupt at the touch edge (may be NULL).
+ *
+ * Return:
+ * - None
+ */
+void LimitSwitch_InitInterrupt(LimitSwitch_TypeDef *limitSwitch, LimitSwitch_CallbackTypeDef onTouched)
+{
+    if (limitSwitch == NULL)
+        return;
+
+    GPIO_InitTypeDef GPIO_InitStruct = { 0 };
+
+    limitSwitch->onTouched = onTouched;
+    limitSwitch->waitingTask = NULL;
+    limitSwitch->touchTimestamp = 0;
+
+    /* Both edges: the touch level depends on the wiring selected above */
+    GPIO_InitStruct.Pin = limitSwitch->GPIO_pin;
+    GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING_FALLING;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+
+#if (C_PIN_IS_CONNECTED_TO_GND)
+    GPIO_InitStruct.Pull = GPIO_PULLUP;
+#else
+    GPIO_InitStruct.Pull = GPIO_PULLDOWN;
+#endif // C_PIN_IS_CONNECTED_TO_GND
+
+    HAL_GPIO_Init(limitSwitch->GPIOx, &GPIO_InitStruct);
+}
+
+/*
+ * Description :
+ * EXTI service of the limit switch, to be called from the EXTI handler of its pin.
+ *
+ * Parameters:
+ * - limitSwitch: A pointer to the LimitSwitch structure containing the port and pin information.
+ *
+ * Return:
+ * - None
+ */
+void LimitSwitch_IRQHandler(LimitSwitch_TypeDef *limitSwitch)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    TaskHandle_t waitingTask;
+
+    if ((limitSwitch == NULL) || !LimitSwitch_IsPressed(limitSwitch))
+        return;     // Release edge (or bounce back): nothing to do
+
+    limitSwitch->touchTimestamp = CycleCounter_Get();
+
+    if (limitSwitch->onTouched != NULL)
+        limitSwitch->onTouched(limitSwitch);
+
+    waitingTask = limitSwitch->waitingTask;
+    if (waitingTask != NULL)
+    {
+        xTaskNotifyFromISR(waitingTask, LIMIT_SWITCH_NOTIFY_BIT, eSetBits, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+}
+
+/*
+ * Description :
+ * Block the calling task until the limit switch is touched or the timeout expires.
+ *
+ * Parameters:
+ * - limitSwitch: A pointer to the LimitSwitch structure (initialized with LimitSwitch_InitInterrupt()).
+ * - timeout: Maximum time to wait, in ticks (portMAX_DELAY to wait forever).
+ *
+ * Return:
+ * - LimitSwitchState_e: TOUCHED if the switch was reached, UNTOUCHED on timeout.
+ */
+LimitSwitchState_e LimitSwitch_WaitTouched(LimitSwitch_TypeDef *limitSwitch, TickType_t timeout)
+{
+    TimeOut_t timeOutState;
+    LimitSwitchState_e currentState;
+
+    if (limitSwitch == NULL)
+        return UNDEFINED;
+
+    /* Register before checking the pin, so an edge in between leaves the bit pending */
+    limitSwitch->waitingTask = xTaskGetCurrentTaskHandle();
+    vTaskSetTimeOutState(&timeOutState);
+
+    /* Other notification bits may wake us too: re-check the pin every time */
+    while (!LimitSwitch_IsPressed(limitSwitch))
+    {
+        if (xTaskCheckForTimeOut(&timeOutState, &timeout) == pdTRUE)
+            break;
+
+        xTaskNotifyWait(0, LIMIT_SWITCH_NOTIFY_BIT, NULL, timeout);
+    }
+
+    limitSwitch->waitingTask = NULL;
+    currentState = LimitSwitch_GetState(limitSwitch);
+
+    return currentState;
+}
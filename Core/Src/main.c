@@ -23,6 +23,20 @@
 #include "button.h"
 #include "limit_switch.h"
 #include "dc_motor.h"
+#include "cycle_counter.h"
+#include "debounce.h"
+#include "press_classifier.h"
+#include "position_estimator.h"
+#include "encoder.h"
+#include "pid.h"
+#include "current_sense.h"
+#include "ripple_counter.h"
+#include "speed_monitor.h"
+#include "friction_map.h"
+#include "rate_group.h"
+#include "window_fsm.h"
+#include "signal_bench.h"
+#include "exti_dispatch.h"
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
@@ -37,6 +51,92 @@
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
 
+/* Task notification bits set by Debounce_EdgeCallback() for the panel tasks (press and release
+ * edge of each button: a tap may complete before the task runs, both edges stay pending) */
+#define PWC_EVT_UP_PRESS         (1UL << 0)
+#define PWC_EVT_DOWN_PRESS       (1UL << 1)
+#define PWC_EVT_UP_RELEASE       (1UL << 8)
+#define PWC_EVT_DOWN_RELEASE     (1UL << 9)
+
+/* Task notification bit set by LockPassengerTask for the lockable panels */
+#define PWC_EVT_LOCK_CHANGED     (1UL << 4)
+
+/* Task notification bits of JamTask: jam detected (interrupt), end of the reversal time (timer) */
+#define PWC_EVT_JAM              (1UL << 5)
+#define PWC_EVT_JAM_REVERSAL_END (1UL << 6)
+
+/* Task notification bit of LockPassengerTask: lock switch edge (EXTI2) */
+#define PWC_EVT_LOCK_SWITCH      (1UL << 7)
+
+/* Task notification bits set by MotorTask for the requester of a PWC_MoveTo() */
+#define PWC_EVT_MOVE_DONE        (1UL << 2)
+#define PWC_EVT_MOVE_ABORTED     (1UL << 3)
+#define PWC_EVT_ALL              (0xFFFFFFFFUL)
+
+/* Window state bits (xWindowEvents event group) */
+#define PWC_INHIBIT_PASSENGER    (1UL << 0)   // Window lock switch on: passenger panel disabled
+
+/* Safety timeout of a one-touch travel between the limit switches */
+#define PWC_TRAVEL_TIMEOUT_MS    (10000U)
+
+/* Trajectory update period of a PWC_MoveTo() (fixed rate, also the PID loop period) */
+#define PWC_MOVE_PERIOD_MS       (20U)
+
+/* Window position source:
+ * - PWC_POSITION_DEAD_RECKONING: sensorless estimate from the motor run time
+ * - PWC_POSITION_ENCODER: quadrature encoder counts (closed-loop PID moves)
+ * - PWC_POSITION_RIPPLE: commutation ripple counts of the motor current (closed-loop PID moves) */
+#define PWC_POSITION_DEAD_RECKONING  (0)
+#define PWC_POSITION_ENCODER         (1)
+#define PWC_POSITION_RIPPLE          (2)
+#define PWC_POSITION_SENSOR          PWC_POSITION_DEAD_RECKONING
+
+/* Idle time measurement window (PWC_MeasureIdle, housekeeping rate group) */
+#define PWC_IDLE_WINDOW_MS           (1000U)
+
+/* Input edge trace: EXTI edge log drained by the housekeeping group in batches */
+#define PWC_INPUT_TRACE_SIZE         (64U)
+#define PWC_INPUT_BATCH              (16U)
+
+/* Jam reversal: the window runs down for this long after a jam (spec: about 0.5 s) */
+#define PWC_JAM_REVERSAL_MS          (500U)
+
+/* Housekeeping rate group period */
+#define PWC_HOUSEKEEPING_PERIOD_MS   (100U)
+
+/* Starvation check of the reversal: every housekeeping release due during the reversal must
+ * have run (one release of margin for the phase of the group). A failed check is counted in
+ * PWC_JamReversalStarvedCount; debug builds also stop there on configASSERT() (H-bridge cut). */
+#define PWC_JAM_REVERSAL_MIN_RUNS    ((PWC_JAM_REVERSAL_MS / PWC_HOUSEKEEPING_PERIOD_MS) - 1U)
+#ifdef DEBUG
+#define PWC_JAM_REVERSAL_ASSERT      (1)
+#else
+#define PWC_JAM_REVERSAL_ASSERT      (0)
+#endif
+
+/* Jam button (PD3): kept as the jam input until a position sensor is configured. Without one
+ * the only pinch detection would be the untuned current and ripple thresholds; with the encoder
+ * or the ripple count the learned speed-drop detector replaces it. */
+#define PWC_JAM_BUTTON_ENABLED       (PWC_POSITION_SENSOR == PWC_POSITION_DEAD_RECKONING)
+
+/* ISR-to-task signalling benchmark (semaphore vs task notification), results in SignalBench_Results */
+#define PWC_SIGNAL_BENCHMARK         (0)
+#define PWC_SIGNAL_BENCHMARK_RUNS    (1000U)
+
+/* The position is a count (encoder or ripple) zeroed on the bottom limit switch */
+#define PWC_POSITION_COUNTED         (PWC_POSITION_SENSOR != PWC_POSITION_DEAD_RECKONING)
+
+/* Counts of a full travel, assumed until the top limit switch is reached from the bottom one */
+#if (PWC_POSITION_SENSOR == PWC_POSITION_RIPPLE)
+#define PWC_DEFAULT_TRAVEL_COUNTS    (600)
+#else
+#define PWC_DEFAULT_TRAVEL_COUNTS    (4000)
+#endif
+
+/* Full travel times assumed until the position estimator calibrates itself on the limit switches */
+#define PWC_DEFAULT_TRAVEL_UP_US    (4000000U)
+#define PWC_DEFAULT_TRAVEL_DOWN_US  (3500000U)
+
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -45,24 +145,69 @@
 /* USER CODE END PM */
 
 /* Private variables ---------------------------------------------------------*/
-osThreadId defaultTaskHandle;
 /* USER CODE BEGIN PV */
 
 // Motor control Commands
 typedef enum {
-	OFF = 1, UP, DOWN
+	OFF = 1, UP, DOWN, MOVE_TO
 } MotorControlCommand_e;
 
-// Semaphore Handles
-xSemaphoreHandle xLockSemaphore;    // Semaphore for lock button handling
-xSemaphoreHandle xBinarySemaphore; // Semaphore for synchronization between ISR and task
-xSemaphoreHandle xJamSemaphore;    // Semaphore for The Jam Task
-xSemaphoreHandle xMotorMutex;     // Motor mutex between driver and passenger
+// Motor command sources, in increasing arbitration priority
+typedef enum {
+	PWC_SRC_PASSENGER, PWC_SRC_DRIVER, PWC_SRC_JAM, PWC_SRC_NUM
+} PWC_CommandSource_e;
+
+// Motor command posted to MotorTask
+typedef struct {
+	MotorControlCommand_e command;
+	PWC_CommandSource_e source;
+	uint32_t timestamp;             // CYCCNT when the command was issued
+	uint16_t target;                // MOVE_TO: target position in 0.1 % (0 = bottom, 1000 = top)
+	TaskHandle_t notifyTask;        // MOVE_TO: task notified of the completion
+} PWC_MotorCommand_TypeDef;
+
+// Go-to-position trajectory
+typedef struct {
+	uint16_t tolerance;             // Arrival window around the target, in 0.1 %
+	uint16_t decelerationDistance;  // Distance before the target where the speed starts to drop, in 0.1 %
+	uint8_t minimumSpeed;           // Approach speed at the target, in percent
+} PWC_MoveConfig_TypeDef;
+
+// Window control panels
+typedef enum {
+	PWC_PANEL_DRIVER, PWC_PANEL_PASSENGER, PWC_PANEL_NUM
+} PWC_Panel_e;
+
+// Panel instance: its buttons and press classifiers, its command source and its state machine
+typedef struct {
+	BUTTON_TypeDef *upButton;
+	BUTTON_TypeDef *downButton;
+	PressClassifier_TypeDef *upPress;
+	PressClassifier_TypeDef *downPress;
+	PWC_CommandSource_e source;
+	uint8_t lockable;               // Disabled by the window lock switch
+	WindowFsm_TypeDef *fsm;
+	TaskHandle_t *task;
+} PWC_Panel_TypeDef;
+
+// Interrupt-to-task signalling: task notifications (PWC_EVT_xxx bits), one word per task
+TaskHandle_t JamHandle;            // Handle for jam task
+TaskHandle_t LockHandle;           // Handle for lock task
+
+// Window state shared with the interrupts (PWC_INHIBIT_xxx), read in O(1) on every input
+EventGroupHandle_t xWindowEvents;
+
+// One-shot software timer ending the jam reversal
+TimerHandle_t xJamReversalTimer;
 
 // Task Handles
 xTaskHandle DriverHandle;         // Handle for driver task
+xTaskHandle PassengerHandle;      // Handle for passenger task
+xTaskHandle MotorHandle;          // Handle for motor owner task
 
-xQueueHandle xQueue;                //Handle for Receive Queue task
+// Latest-wins motor command mailbox: one slot per source, signalled to MotorTask by notification bits
+volatile PWC_MotorCommand_TypeDef PWC_Mailbox[PWC_SRC_NUM];
+volatile uint32_t PWC_MailboxPending = 0;      // Bit n set: slot n not yet consumed
 
 /* Note: If you change the used PORTs here, You Must also go to MX_GPIO_Init() to enable that PORT */
 
@@ -77,10 +222,65 @@ BUTTON_TypeDef LockBtn = { GPIOD, GPIO_PIN_2 };
 
 BUTTON_TypeDef JamButton = { GPIOD, GPIO_PIN_3 };
 
+// Press classification thresholds, one set per panel { long press, double press gap } in us
+const PressClassifier_ConfigTypeDef DriverPressConfig = { 400000U, 300000U };
+const PressClassifier_ConfigTypeDef PassengerPressConfig = { 400000U, 300000U };
+
+// Short (auto) / long (manual) / double (stop) press classifiers, fed by the debounced edges
+PressClassifier_TypeDef DriverUpPress;
+PressClassifier_TypeDef DriverDownPress;
+PressClassifier_TypeDef PassengerUpPress;
+PressClassifier_TypeDef PassengerDownPress;
+
+// Panel state machines (the transition tables are shared, see window_fsm.c)
+WindowFsm_TypeDef DriverPanelFsm;
+WindowFsm_TypeDef PassengerPanelFsm;
+
+const PWC_Panel_TypeDef PWC_Panels[PWC_PANEL_NUM] = {
+	[PWC_PANEL_DRIVER] = { &DriverUpButton, &DriverDownButton, &DriverUpPress, &DriverDownPress,
+			PWC_SRC_DRIVER, 0U, &DriverPanelFsm, &DriverHandle },
+	[PWC_PANEL_PASSENGER] = { &PassengerUpButton, &PassengerDownButton, &PassengerUpPress, &PassengerDownPress,
+			PWC_SRC_PASSENGER, 1U, &PassengerPanelFsm, &PassengerHandle },
+};
+
 // Limit Switch Configurations
 LimitSwitch_TypeDef LimitUpSwitch = { GPIOD, GPIO_PIN_0 };
 LimitSwitch_TypeDef LimitDownSwitch = { GPIOD, GPIO_PIN_1 };
 
+// Go-to-position trajectory { tolerance, deceleration distance, minimum speed }
+const PWC_MoveConfig_TypeDef PWC_MoveConfig = { 5U, 150U, 30U };
+
+#if PWC_POSITION_COUNTED
+// Position loop: count error -> signed speed in percent
+#if (PWC_POSITION_SENSOR == PWC_POSITION_RIPPLE)
+const Pid_ConfigTypeDef PWC_PositionPidConfig = { 320, 6, 200, -100, 100 };
+#else
+const Pid_ConfigTypeDef PWC_PositionPidConfig = { 48, 1, 32, -100, 100 };
+#endif
+Pid_TypeDef PWC_PositionPid;
+
+// Counts between the bottom (count 0) and the top limit switch
+volatile int32_t PWC_TravelCounts = PWC_DEFAULT_TRAVEL_COUNTS;
+#endif
+
+// Ripple counter on the motor current blocks { sample rate, hysteresis, minimum period in samples }
+const RippleCounter_ConfigTypeDef PWC_RippleConfig = { CURRENT_SENSE_SAMPLE_RATE_HZ, 12, 8U };
+
+// Anti-pinch detector on the motor current { threshold, slope per block, inrush blanking blocks, speed-up settle blocks }
+const CurrentSense_ConfigTypeDef PWC_PinchConfig = { 2500U, 300U, 150U, 20U };
+
+// Learned pinch threshold along the travel
+// { unlearned threshold, margin above the learned current, learning shift, clean closes before use, flash write interval in ms }
+const FrictionMap_ConfigTypeDef PWC_FrictionConfig = { 2500U, 600U, 2U, 3U, 600000U };
+
+// Speed-drop jam detector on the encoder (TIM5 capture) or ripple periods
+// { speed drop in percent, reference learning shift, clean closes before checking, start-up blanking periods,
+//   settle periods back at the reference speed, reference speed in percent }
+const SpeedMonitor_ConfigTypeDef PWC_SpeedDropConfig = { 30U, 3U, 3U, 12U, 4U, MOTOR_DEFAULT_SPEED };
+
+// Dead-reckoning window position, fed by the motor state changes and the limit switches
+PositionEstimator_TypeDef WindowPosition;
+
 // LED Configurations
 LED_TypeDef USER_LD3_GREEN_LED = { GPIOG, GPIO_PIN_13 };
 LED_TypeDef USER_LD4_RED_LED = { GPIOG, GPIO_PIN_14 };
@@ -93,6 +293,67 @@ EXTI_ConfigTypeDef exti_configA;
 EXTI_HandleTypeDef hextiB;
 EXTI_ConfigTypeDef exti_configB;
 
+// Press-to-motor latency instrumentation (watch from the debugger)
+volatile uint32_t PWC_PressTimestamp = 0;     // CYCCNT of the last press edge not yet served (0 = none)
+volatile uint32_t PWC_PressLatencyUs = 0;     // Last measured press-to-motor latency in microseconds
+volatile uint32_t PWC_PressLatencyMaxUs = 0;  // Worst observed press-to-motor latency in microseconds
+
+// Command currently applied to the motor (shared with the limit switch ISR)
+volatile MotorControlCommand_e PWC_MotorCommand = OFF;
+
+// Source of the request MotorTask is executing (PWC_SRC_NUM: none), updated before it sleeps
+volatile PWC_CommandSource_e PWC_MotorOwner = PWC_SRC_NUM;
+
+// Limit-edge-to-motor-off time: from the limit switch service in the EXTI interrupt to the H-bridge cut
+volatile uint32_t PWC_LimitStopCycles = 0;        // Last limit-edge-to-motor-off time in CPU cycles
+volatile uint32_t PWC_LimitStopMaxCycles = 0;     // Worst observed limit-edge-to-motor-off time in CPU cycles
+volatile uint32_t PWC_LimitStopLatencyUs = 0;     // Last measured latency in microseconds
+volatile uint32_t PWC_LimitStopLatencyMaxUs = 0;  // Worst observed latency in microseconds
+
+// Pinches detected on the motor current (watch from the debugger)
+volatile uint32_t PWC_PinchCount = 0;
+volatile uint16_t PWC_PinchLevel = 0;         // Block mean of the last detection, in ADC counts
+
+// Speed-drop jams and their detection-to-stop latency (watch from the debugger)
+volatile uint32_t PWC_SpeedJamCount = 0;
+volatile uint32_t PWC_JamStopCycles = 0;        // Last jam-edge-to-motor-off time in CPU cycles (H-bridge cut in the ISR)
+volatile uint32_t PWC_JamStopMaxCycles = 0;     // Worst observed jam-edge-to-motor-off time in CPU cycles
+volatile uint32_t PWC_JamStopLatencyUs = 0;     // Last measured detection-to-stop latency in microseconds
+volatile uint32_t PWC_JamStopLatencyMaxUs = 0;  // Worst observed detection-to-stop latency in microseconds
+
+// Jam reversal state machine (JamTask starts it, the reversal timer ends it)
+typedef enum {
+	PWC_JAM_IDLE, PWC_JAM_REVERSING
+} PWC_JamState_e;
+
+volatile PWC_JamState_e PWC_JamState = PWC_JAM_IDLE;
+
+// Lower priority tasks keep running during a reversal: housekeeping releases counted over
+// the last reversal, and reversals where fewer than PWC_JAM_REVERSAL_MIN_RUNS ran (starved)
+volatile uint32_t PWC_JamReversalHousekeepingRuns = 0;
+volatile uint32_t PWC_JamReversalStarvedCount = 0;
+static uint32_t PWC_JamReversalStartRuns = 0;
+
+// CPU time left to the idle task, from the kernel run time statistics (DWT cycles), over
+// windows of PWC_IDLE_WINDOW_MS: what the blocking delays give back to the system
+volatile uint8_t PWC_IdlePercent = 0;        // Last window
+volatile uint8_t PWC_IdleMinPercent = 100;   // Busiest window since boot
+volatile uint32_t PWC_IdleTotalMs = 0;       // Idle time since boot
+
+// Every button, limit switch and lock/jam edge in order, with the CYCCNT of its interrupt entry
+// (logged by the EXTI dispatcher without kernel calls, watch from the debugger)
+EventRing_EventTypeDef PWC_InputTrace[PWC_INPUT_TRACE_SIZE];    // Last edges (circular)
+volatile uint32_t PWC_InputTraceCount = 0;                      // Edges drained since boot (next slot: count % size)
+volatile uint32_t PWC_InputEdgeCount[EXTI_DISPATCH_NUM_LINES];  // Edges per EXTI line
+volatile uint32_t PWC_InputEventsDropped = 0;                   // Edges lost on a full log
+
+// Motor command arbitration statistics (watch from the debugger)
+volatile uint32_t PWC_CommandLatencyUs = 0;     // Last command-to-output latency in microseconds
+volatile uint32_t PWC_CommandLatencyMaxUs = 0;  // Worst observed command-to-output latency in microseconds
+volatile uint32_t PWC_RejectedCommands = 0;     // Commands dropped by priority arbitration
+volatile uint32_t PWC_CoalescedCommands = 0;    // Unread commands replaced by a newer one of the same source
+volatile uint32_t PWC_TravelTimeouts = 0;       // Travels stopped by PWC_TRAVEL_TIMEOUT_MS
+
 ///*******************************************************************************
 // *                           Functions Definitions                             *
 // *******************************************************************************/
@@ -102,18 +363,87 @@ EXTI_ConfigTypeDef exti_configB;
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
-void StartDefaultTask(void const *argument);
 
 void LockPassengerTask(void *pvParameters);
 void JamTask(void *pvParameters);
-void DriverTask(void *pvParamters);
-void receiveQueue(void *pvParameters);
-void PassengerTask(void *pvParamters);
-
-void PWC_motorControl(MotorControlCommand_e command);
+static void PWC_JamReversalEnd(TimerHandle_t xTimer);
+#if PWC_SIGNAL_BENCHMARK
+static void PWC_SignalBenchTask(void *pvParameters);
+#endif
+static void PWC_MeasureIdle(void);
+static void PWC_DrainInputEvents(void);
+void MotorTask(void *pvParameters);
+void PanelTask(void *pvParameters);
+static void PWC_PanelSync(const PWC_Panel_TypeDef *panel);
+static void PWC_PanelAction(const PWC_Panel_TypeDef *panel, WindowFsm_Action_e action);
+static void PWC_PanelButton(const PWC_Panel_TypeDef *panel, PressClassifier_TypeDef *classifier, uint32_t events,
+		uint32_t pressEvent, uint32_t releaseEvent, WindowFsm_Event_e press, WindowFsm_Event_e releaseShort,
+		WindowFsm_Event_e releaseLong, WindowFsm_Event_e releaseDouble);
+
+void PWC_motorControl(MotorControlCommand_e command, uint8_t speed);
+static void PWC_motorSpeed(uint8_t speed);
+void PWC_SendCommand(PWC_CommandSource_e source, MotorControlCommand_e command);
+void PWC_MoveTo(PWC_CommandSource_e source, uint16_t target);
+static void PWC_PostCommand(const PWC_MotorCommand_TypeDef *motorCommand);
+static MotorControlCommand_e PWC_MoveStep(uint16_t target, MotorControlCommand_e direction, uint8_t *speed);
+static uint8_t PWC_MoveArrived(uint16_t target);
+static void PWC_MoveEnd(TaskHandle_t *notifyTask, uint32_t event);
+static void PWC_RecordPressLatency(void);
+static void PWC_JamStop(uint32_t timestamp);
+static void PWC_SpeedDropped(uint32_t timestamp);
+static uint16_t PWC_ReadPosition(void);
+static void PWC_LimitReached(LimitSwitch_TypeDef *limitSwitch);
+static void PWC_ButtonEdge(void *context);
+static void PWC_LimitSwitchEdge(void *context);
+static void PWC_LockEdge(void *context);
+#if PWC_JAM_BUTTON_ENABLED
+static void PWC_JamEdge(void *context);
+#endif
+#if PWC_SIGNAL_BENCHMARK
+static void PWC_SignalBenchEdge(void *context);
+#endif
+static void PWC_ClassifyEdge(PressClassifier_TypeDef *classifier, BUTTON_TypeDef *button,
+		uint32_t pressed, uint32_t released, uint32_t timestamp);
+static inline uint32_t PWC_ButtonMask(BUTTON_TypeDef *button);
+#if PWC_POSITION_COUNTED
+static inline int32_t PWC_PositionCount(void);
+static inline void PWC_SetPositionCount(int32_t count);
+#endif
 void EXTI_Initialization();
 static void MX_NVIC_Init(void);
 
+// Fixed-rate executive: every group is a task released by vTaskDelayUntil(), jitter and
+// overrun counters in PWC_RateGroups[] (watch from the debugger)
+typedef enum {
+	PWC_RATE_HOUSEKEEPING, PWC_RATE_NUM
+} PWC_RateGroup_e;
+
+static const RateGroup_Job PWC_HousekeepingJobs[] = { FrictionMap_Service, SpeedMonitor_Service, PWC_MeasureIdle, PWC_DrainInputEvents };
+
+const RateGroup_ConfigTypeDef PWC_RateGroupConfig[PWC_RATE_NUM] = {
+	// 10 Hz, low priority: friction map merge and flash erase polling, idle statistics, input trace
+	[PWC_RATE_HOUSEKEEPING] = { "housekeep", PWC_HOUSEKEEPING_PERIOD_MS, 2U, 192U, PWC_HousekeepingJobs, 4U },
+};
+
+RateGroup_TypeDef PWC_RateGroups[PWC_RATE_NUM];
+
+// EXTI handlers indexed by line (= pin number), one indirect call per pending line (exti_dispatch.c)
+const ExtiDispatch_EntryTypeDef PWC_ExtiHandlers[EXTI_DISPATCH_NUM_LINES] = {
+	[0]  = { PWC_LimitSwitchEdge, &LimitUpSwitch },      // Upper limit switch (PD0)
+	[1]  = { PWC_LimitSwitchEdge, &LimitDownSwitch },    // Lower limit switch (PD1)
+	[2]  = { PWC_LockEdge, NULL },                       // Lock switch (PD2)
+#if PWC_JAM_BUTTON_ENABLED
+	[3]  = { PWC_JamEdge, NULL },                        // Jam button (PD3)
+#endif
+#if PWC_SIGNAL_BENCHMARK
+	[4]  = { PWC_SignalBenchEdge, NULL },                // Software trigger of the signalling benchmark
+#endif
+	[9]  = { PWC_ButtonEdge, &PassengerDownButton },     // Passenger down button (PD9)
+	[10] = { PWC_ButtonEdge, &DriverUpButton },          // Driver up button (PB10)
+	[11] = { PWC_ButtonEdge, &DriverDownButton },        // Driver down button (PB11)
+	[12] = { PWC_ButtonEdge, &PassengerUpButton },       // Passenger up button (PB12)
+};
+
 /**
  *
  * @brief  The application entry point.
@@ -125,53 +455,84 @@ int main(void) {
 
 	SystemClock_Config();
 
+	CycleCounter_Init();
+
 	MX_GPIO_Init();
 
+	ExtiDispatch_Register(PWC_ExtiHandlers);
+
 	MX_NVIC_Init();
 
 	BUTTON_Init(&LockBtn);
 
-	BUTTON_Init(&PassengerUpButton);
-	BUTTON_Init(&PassengerDownButton);
+	BUTTON_InitInterrupt(&PassengerUpButton);
+	BUTTON_InitInterrupt(&PassengerDownButton);
 
-	BUTTON_Init(&DriverUpButton);
-	BUTTON_Init(&DriverDownButton);
+	BUTTON_InitInterrupt(&DriverUpButton);
+	BUTTON_InitInterrupt(&DriverDownButton);
 
 	BUTTON_Init(&JamButton);
 
-	LimitSwitch_Init(&LimitUpSwitch);
-	LimitSwitch_Init(&LimitDownSwitch);
+	Debounce_Init(PWC_ButtonMask(&DriverUpButton) | PWC_ButtonMask(&DriverDownButton)
+			| PWC_ButtonMask(&PassengerUpButton) | PWC_ButtonMask(&PassengerDownButton));
+
+	PressClassifier_Init(&DriverUpPress, &DriverPressConfig);
+	PressClassifier_Init(&DriverDownPress, &DriverPressConfig);
+	PressClassifier_Init(&PassengerUpPress, &PassengerPressConfig);
+	PressClassifier_Init(&PassengerDownPress, &PassengerPressConfig);
+
+	LimitSwitch_InitInterrupt(&LimitUpSwitch, PWC_LimitReached);
+	LimitSwitch_InitInterrupt(&LimitDownSwitch, PWC_LimitReached);
 
 	LED_Init(&USER_LD3_GREEN_LED);
 	LED_Init(&USER_LD4_RED_LED);
 
+	PositionEstimator_Init(&WindowPosition, PWC_DEFAULT_TRAVEL_UP_US, PWC_DEFAULT_TRAVEL_DOWN_US);
+
 	DcMotor_Init();
 
+	RippleCounter_Init(&PWC_RippleConfig);
+	FrictionMap_Init(&PWC_FrictionConfig);
+	CurrentSense_Init(&PWC_PinchConfig);
+
+	SpeedMonitor_Init(&PWC_SpeedDropConfig);
+#if (PWC_POSITION_SENSOR == PWC_POSITION_ENCODER)
+	SpeedMonitor_StartCapture();     // Encoder channel A periods; otherwise the ripple periods feed the detector
+#endif
+
+#if (PWC_POSITION_SENSOR == PWC_POSITION_ENCODER)
+	Encoder_Init();
+#endif
+#if PWC_POSITION_COUNTED
+	Pid_Init(&PWC_PositionPid, &PWC_PositionPidConfig);
+#endif
+
 	EXTI_Initialization();
 
 	HAL_EXTI_SetConfigLine(&hextiA, &exti_configA);
 
 	HAL_EXTI_SetConfigLine(&hextiB, &exti_configB);
 
-	xMotorMutex = xSemaphoreCreateMutex();
-
-	xQueue = xQueueCreate(2, sizeof(long));
+	xWindowEvents = xEventGroupCreate();
 
-	vSemaphoreCreateBinary(xBinarySemaphore);
-	vSemaphoreCreateBinary(xLockSemaphore);
-	vSemaphoreCreateBinary(xJamSemaphore);
+	xJamReversalTimer = xTimerCreate("JamRev", pdMS_TO_TICKS(PWC_JAM_REVERSAL_MS), pdFALSE, NULL, PWC_JamReversalEnd);
 
-	osThreadDef(defaultTask, StartDefaultTask, osPriorityNormal, 0, 128);
-	defaultTaskHandle = osThreadCreate(osThread(defaultTask), NULL);
-
-	if (xBinarySemaphore != NULL) // Check if binary semaphore was created successfully
+	if ((xWindowEvents != NULL) && (xJamReversalTimer != NULL)) // Check if the kernel objects were created successfully
 	{
 		// Create tasks
-		xTaskCreate(JamTask, "JamTask", 270, NULL, 5, NULL);   //Create Jam Task
-		xTaskCreate(LockPassengerTask, "LockTask", 270, NULL, 4, NULL); // Create lock task
-		xTaskCreate(receiveQueue, "recieveQueue", 270, NULL, 3, NULL); //Create Receive task
-		xTaskCreate(PassengerTask, "passenger", 270, NULL, 1, NULL); // Create passenger task
-		xTaskCreate(DriverTask, "driver", 270, NULL, 1, &DriverHandle); // Create driver task
+		xTaskCreate(JamTask, "JamTask", 270, NULL, 5, &JamHandle);   //Create Jam Task
+		xTaskCreate(LockPassengerTask, "LockTask", 270, NULL, 4, &LockHandle); // Create lock task
+		xTaskCreate(MotorTask, "motor", 270, NULL, 6, &MotorHandle); // Create motor owner task (highest priority)
+		xTaskCreate(PanelTask, "passenger", 270, (void *)&PWC_Panels[PWC_PANEL_PASSENGER], 1, &PassengerHandle); // Create passenger task
+		xTaskCreate(PanelTask, "driver", 270, (void *)&PWC_Panels[PWC_PANEL_DRIVER], 1, &DriverHandle); // Create driver task
+
+		// Create the fixed-rate tasks
+		for (uint32_t group = 0; group < PWC_RATE_NUM; group++)
+			RateGroup_Create(&PWC_RateGroups[group], &PWC_RateGroupConfig[group]);
+
+#if PWC_SIGNAL_BENCHMARK
+		xTaskCreate(PWC_SignalBenchTask, "bench", 192, NULL, 1, NULL);
+#endif
 
 		osKernelStart();
 	}
@@ -180,187 +541,760 @@ int main(void) {
 
 }
 
-// Helper Function For Power Window Control Module (PWC)
-void PWC_motorControl(MotorControlCommand_e command) {
+// Helper Function For Power Window Control Module (PWC), only called from MotorTask
+void PWC_motorControl(MotorControlCommand_e command, uint8_t speed) {
+
+	// Never drive into a limit switch that is already touched (its edge is gone)
+	if (((command == UP) && LimitSwitch_IsPressed(&LimitUpSwitch))
+			|| ((command == DOWN) && LimitSwitch_IsPressed(&LimitDownSwitch)))
+		command = OFF;
+
+	// The limit switch ISR may cut the motor at any time: keep outputs and PWC_MotorCommand consistent
+	taskENTER_CRITICAL();
+
 	switch (command) {
 	case OFF:
-		DcMotor_Rotate(STOP);
+		DcMotor_Stop();    // Soft stop, the limit switch ISR still cuts a decelerating motor
+		PWC_MotorCommand = OFF;
 		break;
 	case UP:
+		DcMotor_SetSpeed(speed);
 		DcMotor_Rotate(ClockWise);
+		PWC_MotorCommand = UP;
+		PWC_RecordPressLatency();
 		break;
 	case DOWN:
+		DcMotor_SetSpeed(speed);
 		DcMotor_Rotate(Anti_ClockWise);
+		PWC_MotorCommand = DOWN;
+		PWC_RecordPressLatency();
 		break;
 	default:
 		// DO Nothing
 		break;
 	}
+
+	taskEXIT_CRITICAL();
+}
+
+// Helper Function: change the speed of the running travel (ramped by the motor driver), only called from MotorTask
+static void PWC_motorSpeed(uint8_t speed) {
+
+	taskENTER_CRITICAL();
+	DcMotor_SetSpeed(speed);
+	taskEXIT_CRITICAL();
 }
 
+// Limit switch touched (EXTI0/EXTI1 interrupt): cut the motor at the exact edge
+static void PWC_LimitReached(LimitSwitch_TypeDef *limitSwitch) {
+
+	DcMotor_State motorState = DcMotor_GetState();
+	uint32_t cycles;
+
+	// Check the driven direction, not the command: a soft stop keeps the motor turning for a while
+	if (((limitSwitch == &LimitUpSwitch) && (motorState == ClockWise))
+			|| ((limitSwitch == &LimitDownSwitch) && (motorState == Anti_ClockWise))) {
+		DcMotor_Cut();
+		cycles = CycleCounter_Get() - limitSwitch->touchTimestamp;
+
+		if (limitSwitch == &LimitUpSwitch) {
+			FrictionMap_EndRun(1);   // Closed up to the top without a pinch: learn this run
+			SpeedMonitor_EndRun(1);
+		}
+		DcMotor_Rotate(STOP);
+		PWC_MotorCommand = OFF;
+
+		PWC_LimitStopCycles = cycles;
+		if (cycles > PWC_LimitStopMaxCycles)
+			PWC_LimitStopMaxCycles = cycles;
+		PWC_LimitStopLatencyUs = CycleCounter_ToMicroseconds(cycles);
+		if (PWC_LimitStopLatencyUs > PWC_LimitStopLatencyMaxUs)
+			PWC_LimitStopLatencyMaxUs = PWC_LimitStopLatencyUs;
+	}
+
+#if PWC_POSITION_COUNTED
+	// The position counts from the bottom limit switch, the top one gives the travel length
+	if (limitSwitch == &LimitDownSwitch)
+		PWC_SetPositionCount(0);
+	else if (PWC_PositionCount() > 0)
+		PWC_TravelCounts = PWC_PositionCount();
+#endif
+
+	// Exact end of travel: re-reference (and recalibrate) the position estimate
+	PositionEstimator_OnLimit(&WindowPosition,
+			(limitSwitch == &LimitUpSwitch)? POSITION_LIMIT_TOP : POSITION_LIMIT_BOTTOM,
+			limitSwitch->touchTimestamp);
+}
+
+// Motor state changed (motor task critical section, limit switch or ramp DMA interrupt)
+void DcMotor_StateCallback(DcMotor_State state, uint8_t speed) {
+
+	static DcMotor_State previousState = STOP;
+	static uint8_t previousSpeed = 0;
+	PositionMotion_e motion = POSITION_STOPPED;
+
+	if (state == ClockWise)
+		motion = POSITION_MOVING_UP;
+	else if (state == Anti_ClockWise)
+		motion = POSITION_MOVING_DOWN;
+
+	PositionEstimator_OnMotion(&WindowPosition, motion, speed, CycleCounter_Get());
+
+	// Anti-pinch only while closing. Only the start of a closing run gets the inrush blanking:
+	// a PWC_MoveTo() changes the duty every step and must stay checked up to its target. A speed
+	// increase only needs a short settle while the current follows the ramp. The speed reference
+	// is learned at full duty: the speed-drop check pauses at any other set point.
+	if (state == ClockWise) {
+		if (previousState != ClockWise) {
+			CurrentSense_Arm();
+			SpeedMonitor_Arm();
+			FrictionMap_StartRun();
+			SpeedMonitor_StartRun();
+		} else if (speed > previousSpeed) {
+			CurrentSense_Settle();
+		}
+		SpeedMonitor_SetSpeed(speed);
+	} else {
+		CurrentSense_Disarm();
+		SpeedMonitor_Disarm();
+		FrictionMap_EndRun(0);   // Stopped, reversed or cut by a pinch before the top
+		SpeedMonitor_EndRun(0);
+	}
+
+	previousState = state;
+	previousSpeed = speed;
+}
+
+// Pinch detected on the motor current (DMA interrupt, end of a block): cut the motor here,
+// the jam task then reverses the window
+void CurrentSense_PinchCallback(uint16_t level) {
+
+	uint32_t timestamp = CycleCounter_Get();
+
+	if (DcMotor_GetState() != ClockWise)
+		return;
+
+	PWC_PinchCount++;
+	PWC_PinchLevel = level;
+	PWC_JamStop(timestamp);
+}
+
+// Jam top half (priority 5 interrupt, or a lower one inside taskENTER_CRITICAL_FROM_ISR()):
+// cut the H-bridge with one register write, then update the motor state and wake the jam task
+// for the reversal. The timestamp is the jam edge or detection.
+static void PWC_JamStop(uint32_t timestamp) {
+
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	uint32_t cycles;
+
+	if (DcMotor_GetState() != ClockWise)
+		return;    // Jam protection while closing only
+
+	DcMotor_Cut();
+	cycles = CycleCounter_Get() - timestamp;
+
+	DcMotor_Rotate(STOP);
+	PWC_MotorCommand = OFF;
+
+	PWC_JamStopCycles = cycles;
+	if (cycles > PWC_JamStopMaxCycles)
+		PWC_JamStopMaxCycles = cycles;
+	PWC_JamStopLatencyUs = CycleCounter_ToMicroseconds(cycles);
+	if (PWC_JamStopLatencyUs > PWC_JamStopLatencyMaxUs)
+		PWC_JamStopLatencyMaxUs = PWC_JamStopLatencyUs;
+
+	if (JamHandle != NULL)
+		xTaskNotifyFromISR(JamHandle, PWC_EVT_JAM, eSetBits, &xHigherPriorityTaskWoken);
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+#if PWC_POSITION_COUNTED
+// Position count of the selected sensor (hardware encoder count or ripple count)
+static inline int32_t PWC_PositionCount(void) {
+#if (PWC_POSITION_SENSOR == PWC_POSITION_ENCODER)
+	return Encoder_GetCount();
+#else
+	return RippleCounter_GetCount();
+#endif
+}
+
+static inline void PWC_SetPositionCount(int32_t count) {
+#if (PWC_POSITION_SENSOR == PWC_POSITION_ENCODER)
+	Encoder_SetCount(count);
+#else
+	RippleCounter_SetCount(count);
+#endif
+}
+#endif
+
+// Motor current block (DMA interrupt): count the commutation ripples in the driven direction
+void CurrentSense_BlockCallback(const volatile uint16_t *block) {
+
+	uint32_t timestamp = CycleCounter_Get();   // The ripple period of this block is measured here
+	DcMotor_State state = DcMotor_GetState();
+	int32_t count = RippleCounter_GetCount();
+	uint16_t position;
+
+	RippleCounter_ProcessBlock(block, CURRENT_SENSE_BLOCK_SIZE,
+			(state == ClockWise)? 1 : ((state == Anti_ClockWise)? -1 : 0));
+
+	position = PWC_ReadPosition();
+
+	// Learn the closing current of this position, and use its pinch threshold for the next block
+	if ((state == ClockWise) && CurrentSense_IsMonitoring())
+		FrictionMap_RecordLevel(position, CurrentSense_GetLevel());
+	CurrentSense_SetThreshold(FrictionMap_GetThreshold(position));
+
+#if (PWC_POSITION_SENSOR != PWC_POSITION_ENCODER)
+	// New ripple peak while closing: check its period against the learned speed at this position
+	if ((state == ClockWise) && (RippleCounter_GetCount() != count)
+			&& SpeedMonitor_Check(RippleCounter_GetPeriodUs(), position))
+		PWC_SpeedDropped(timestamp);
+#else
+	(void)count;
+	(void)timestamp;
+#endif
+}
+
+#if (PWC_POSITION_SENSOR == PWC_POSITION_ENCODER)
+// Encoder channel A period (TIM5 capture interrupt): check it against the learned speed at this position
+void SpeedMonitor_CaptureCallback(uint32_t periodUs, uint32_t timestamp) {
+
+	if ((DcMotor_GetState() == ClockWise) && SpeedMonitor_Check(periodUs, PWC_ReadPosition()))
+		PWC_SpeedDropped(timestamp);
+}
+#endif
+
+// The window slowed down while closing (priority 5 interrupt): stop it, the jam task reverses it.
+// The timestamp is the entry of the interrupt that measured the slow period.
+static void PWC_SpeedDropped(uint32_t timestamp) {
+
+	PWC_SpeedJamCount++;
+	PWC_JamStop(timestamp);
+}
+
+// Window position in 0.1 % without locking: priority 5 interrupts (same level as every position update)
+// or a task critical section
+static uint16_t PWC_ReadPosition(void) {
+
+#if PWC_POSITION_COUNTED
+	int32_t count = PWC_PositionCount();
+	int32_t travelCounts = PWC_TravelCounts;
+
+	if (count <= 0)
+		return 0;
+	if (count >= travelCounts)
+		return 1000U;
+	return (uint16_t)(((int64_t)count * 1000) / travelCounts);
+#else
+	return PositionEstimator_Get(&WindowPosition, CycleCounter_Get());
+#endif
+}
+
+// Estimated window position in 0.1 % of the full travel (0 = bottom, 1000 = top), task context only
+uint16_t PWC_GetPosition(void) {
+
+	uint16_t position;
+
+#if PWC_POSITION_COUNTED
+	position = PWC_ReadPosition();
+#else
+	// The motor state changes from interrupts at the kernel syscall priority: read a consistent estimate
+	taskENTER_CRITICAL();
+	position = PWC_ReadPosition();
+	taskEXIT_CRITICAL();
+#endif
+
+	return position;
+}
+
+// Debounced input mask of a window button
+static inline uint32_t PWC_ButtonMask(BUTTON_TypeDef *button) {
+	return DEBOUNCE_MASK(button->GPIOx, button->GPIO_pin);
+}
+
+// Close the press-to-motor measurement started by the button EXTI callback
+static void PWC_RecordPressLatency(void) {
+	uint32_t pressTimestamp = PWC_PressTimestamp;
+
+	if (pressTimestamp == 0)
+		return;   // Motor moved without a pending press (e.g. jam reversal)
+
+	PWC_PressTimestamp = 0;
+	PWC_PressLatencyUs = CycleCounter_ToMicroseconds(CycleCounter_Get() - pressTimestamp);
+
+	if (PWC_PressLatencyUs > PWC_PressLatencyMaxUs)
+		PWC_PressLatencyMaxUs = PWC_PressLatencyUs;
+}
+
+// Window lock: keep PWC_INHIBIT_PASSENGER in step with the lock switch. The passenger input is
+// dropped by Debounce_EdgeCallback() while it is set, no task priority is changed
 void LockPassengerTask(void *pvParameters) {
-	xSemaphoreTake(xLockSemaphore, 0); // Attempt to take semaphore (non-blocking)
+	const PWC_Panel_TypeDef *panel;
 
 	while (1) {
-		// Take semaphore (blocking)
-		xSemaphoreTake(xLockSemaphore, portMAX_DELAY);
-
-		// Check lock button state
+		// Check lock button state (also applies the switch position at start-up)
 		if (BUTTON_IsPressed(&LockBtn)) {
 			LED_Output(&USER_LD4_RED_LED, LED_ON); // Turn RED LED ON for indication
-			vTaskPrioritySet(DriverHandle, 2); // Change Driver Task Priority to 2
+			xEventGroupSetBits(xWindowEvents, PWC_INHIBIT_PASSENGER);
 		} else {
 			LED_Output(&USER_LD4_RED_LED, LED_OFF); // Turn RED LED OFF for indication
-			vTaskPrioritySet(DriverHandle, 1); // Change Driver Task Priority to 1
+			xEventGroupClearBits(xWindowEvents, PWC_INHIBIT_PASSENGER);
 		}
+
+		// The lockable panels receive no input while locked: move their state machine now
+		for (panel = &PWC_Panels[0]; panel < &PWC_Panels[PWC_PANEL_NUM]; panel++)
+			if (panel->lockable && (*panel->task != NULL))
+				xTaskNotify(*panel->task, PWC_EVT_LOCK_CHANGED, eSetBits);
+
+		// Sleep until the next lock switch edge
+		xTaskNotifyWait(0, PWC_EVT_ALL, NULL, portMAX_DELAY);
 	}
 }
 
 void JamTask(void *pvParameters) {
-	xSemaphoreTake(xJamSemaphore, 0);
+	uint32_t events;
+	uint32_t runs;
+
 	for (;;) {
-		xSemaphoreTake(xJamSemaphore, portMAX_DELAY);
+		xTaskNotifyWait(0, PWC_EVT_ALL, &events, portMAX_DELAY);
+
+		// Reversal time elapsed: stop the window
+		if ((events & PWC_EVT_JAM_REVERSAL_END) && (PWC_JamState == PWC_JAM_REVERSING)) {
+			PWC_SendCommand(PWC_SRC_JAM, OFF);
+			PWC_JamState = PWC_JAM_IDLE;
+
+			// Pass / fail: the lower priority housekeeping group was not starved by the reversal
+			runs = PWC_RateGroups[PWC_RATE_HOUSEKEEPING].activations - PWC_JamReversalStartRuns;
+			PWC_JamReversalHousekeepingRuns = runs;
+			if (runs < PWC_JAM_REVERSAL_MIN_RUNS) {
+				PWC_JamReversalStarvedCount++;
+#if PWC_JAM_REVERSAL_ASSERT
+				DcMotor_Cut();     // Halt with the window stopped, not running down
+				configASSERT(runs >= PWC_JAM_REVERSAL_MIN_RUNS);
+#endif
+			}
+		}
+
+		if (events & PWC_EVT_JAM) {
+			/* The motor was already cut by the interrupt that detected the jam: only reverse here.
+			 * Turn The motor down (preempts any panel command), the reversal timer stops it */
+			PWC_JamReversalStartRuns = PWC_RateGroups[PWC_RATE_HOUSEKEEPING].activations;
+			PWC_JamState = PWC_JAM_REVERSING;
+			PWC_SendCommand(PWC_SRC_JAM, DOWN);
 
-		/* Turn The motor to simulate the window moving */
-		PWC_motorControl(DOWN);
+			/* A jam during a reversal restarts the full reversal time */
+			xTimerReset(xJamReversalTimer, portMAX_DELAY);
+		}
+	}
+}
+
+// Reversal time elapsed (timer service task): hand the stop to the jam task
+static void PWC_JamReversalEnd(TimerHandle_t xTimer) {
+
+	(void)xTimer;
+
+	xTaskNotify(JamHandle, PWC_EVT_JAM_REVERSAL_END, eSetBits);
+}
 
-		/* Delay for 2.0 seconds ( to be clearly seen in the video */
-		HAL_Delay(2000);
+#if PWC_SIGNAL_BENCHMARK
+// One-shot: measure the interrupt-to-task signalling latency, then exit
+static void PWC_SignalBenchTask(void *pvParameters) {
 
-		/* Clear Pins to stop the motor */
-		PWC_motorControl(OFF);
+	(void)pvParameters;
+
+	SignalBench_Run(PWC_SIGNAL_BENCHMARK_RUNS);
+	vTaskDelete(NULL);
+}
+#endif
+
+// Idle share of the CPU over the last window (housekeeping rate group job)
+static void PWC_MeasureIdle(void) {
+	static uint32_t windowStart = 0;
+	static uint32_t windowIdle = 0;
+	static TickType_t windowTick = 0;
+	uint32_t now;
+	uint32_t idle;
+	uint32_t percent;
+
+	if ((xTaskGetTickCount() - windowTick) < pdMS_TO_TICKS(PWC_IDLE_WINDOW_MS))
+		return;
+
+	// Unsigned differences: valid while a window is shorter than one wrap of the cycle counter
+	now = CycleCounter_Get();
+	idle = ulTaskGetIdleRunTimeCounter();
+
+	if (windowTick != 0) {
+		percent = (uint32_t)(((uint64_t)(idle - windowIdle) * 100U) / (now - windowStart));
+		PWC_IdlePercent = (uint8_t)((percent > 100U)? 100U : percent);
+		if (PWC_IdlePercent < PWC_IdleMinPercent)
+			PWC_IdleMinPercent = PWC_IdlePercent;
+		PWC_IdleTotalMs += CycleCounter_ToMicroseconds(idle - windowIdle) / 1000U;
 	}
+
+	windowStart = now;
+	windowIdle = idle;
+	windowTick = xTaskGetTickCount();
 }
 
-void receiveQueue(void *pvParameters) {
-	int Val;
-	BaseType_t xStatus;
-	while (1) {
-		// Receive from queue (blocking)
-		xStatus = xQueueReceive(xQueue, &Val, portMAX_DELAY);
-		PWC_motorControl(Val);
+// Input edge log consumer (housekeeping group): move the logged edges to the trace in batches
+static void PWC_DrainInputEvents(void) {
+	EventRing_EventTypeDef batch[PWC_INPUT_BATCH];
+	uint32_t count;
+	uint32_t i;
+
+	while ((count = ExtiDispatch_ReadEvents(batch, PWC_INPUT_BATCH)) != 0) {
+		for (i = 0; i < count; i++) {
+			PWC_InputTrace[PWC_InputTraceCount % PWC_INPUT_TRACE_SIZE] = batch[i];
+			PWC_InputTraceCount++;
+			PWC_InputEdgeCount[batch[i].source]++;
+		}
 	}
+
+	PWC_InputEventsDropped = ExtiDispatch_GetDroppedEvents();
 }
 
-void DriverTask(void *pvParamters) {
+// Post a motor command to MotorTask (the only task driving the motor)
+void PWC_SendCommand(PWC_CommandSource_e source, MotorControlCommand_e command) {
+	PWC_MotorCommand_TypeDef motorCommand;
 
-	int Mode = OFF;
+	motorCommand.command = command;
+	motorCommand.source = source;
+	motorCommand.timestamp = CycleCounter_Get();
+	motorCommand.target = 0;
+	motorCommand.notifyTask = NULL;
 
-	for (;;) {
+	PWC_PostCommand(&motorCommand);
+}
 
-		xSemaphoreTake(xMotorMutex, portMAX_DELAY);
-
-		//Handle the Up Button
-		if (BUTTON_IsPressed(&DriverUpButton)) {
-			Mode = UP;
-			xQueueSendToBack(xQueue, &Mode, 0);
-			vTaskDelay(400); // Debounce delay
-
-			if (BUTTON_IsPressed(&DriverUpButton)) {  			// Manual Mode
-				PWC_motorControl(UP);
-				while (BUTTON_IsPressed(&DriverUpButton))
-					;
-				PWC_motorControl(OFF);
-
-			} else { // Automatic Mode
-				PWC_motorControl(UP);
-				while (!LimitSwitch_IsPressed(&LimitUpSwitch))
-					;
-				PWC_motorControl(OFF);
-			}
+// Move the window to a position in 0.1 % (0 = bottom, 1000 = top). The calling task is notified
+// with PWC_EVT_MOVE_DONE on arrival, or PWC_EVT_MOVE_ABORTED if a new command, a limit switch
+// or the travel timeout ends the move first
+void PWC_MoveTo(PWC_CommandSource_e source, uint16_t target) {
+	PWC_MotorCommand_TypeDef motorCommand;
 
-			Mode = OFF;
-			xQueueSendToBack(xQueue, &Mode, 0);
-		}
+	motorCommand.command = MOVE_TO;
+	motorCommand.source = source;
+	motorCommand.timestamp = CycleCounter_Get();
+	motorCommand.target = (target > 1000U)? 1000U : target;
+	motorCommand.notifyTask = xTaskGetCurrentTaskHandle();
 
-		//Handle the Down Button
-		if (BUTTON_IsPressed(&DriverDownButton)) {
-			Mode = DOWN;
-			xQueueSendToBack(xQueue, &Mode, 0);
-			vTaskDelay(400); // Debounce delay
-
-			if (BUTTON_IsPressed(&DriverDownButton)) {  // Manual Mode
-				PWC_motorControl(DOWN);
-				while (BUTTON_IsPressed(&DriverDownButton))
-					;
-				PWC_motorControl(OFF);
-			} else { 								// Automatic Mode
-				PWC_motorControl(DOWN);
-				while (!LimitSwitch_IsPressed(&LimitDownSwitch))
-					;
-				PWC_motorControl(OFF);
-			}
-			Mode = OFF;
-			xQueueSendToBack(xQueue, &Mode, 0);
-		}
+	PWC_PostCommand(&motorCommand);
+}
+
+static void PWC_PostCommand(const PWC_MotorCommand_TypeDef *motorCommand) {
+	uint32_t sourceBit = 1UL << motorCommand->source;
+
+	// Latest wins: an unread command of the same source is replaced, never queued behind
+	taskENTER_CRITICAL();
+	if (PWC_MailboxPending & sourceBit)
+		PWC_CoalescedCommands++;
+	PWC_Mailbox[motorCommand->source] = *motorCommand;
+	PWC_MailboxPending |= sourceBit;
+	taskEXIT_CRITICAL();
+
+	if (MotorHandle != NULL)
+		xTaskNotify(MotorHandle, sourceBit, eSetBits);
+}
+
+// One trajectory step of a PWC_MoveTo(): returns the direction to drive and its speed, OFF once arrived
+static MotorControlCommand_e PWC_MoveStep(uint16_t target, MotorControlCommand_e direction, uint8_t *speed) {
+#if PWC_POSITION_COUNTED
+	int32_t travelCounts = PWC_TravelCounts;
+	int32_t error = (int32_t)(((int64_t)target * travelCounts) / 1000) - PWC_PositionCount();
+	int32_t tolerance = ((int32_t)PWC_MoveConfig.tolerance * travelCounts) / 1000;
+	int32_t output;
+
+	UNUSED(direction);   // Closed loop: an overshoot is corrected by the PID
+
+	if ((error <= tolerance) && (error >= -tolerance))
+		return OFF;
+
+	// Fixed-rate PID on the hardware count, the sign of the output gives the direction
+	output = Pid_Update(&PWC_PositionPid, error);
+	if (output == 0)
+		output = (error > 0)? 1 : -1;
+
+	*speed = (uint8_t)((output > 0)? output : -output);
+	if (*speed < PWC_MoveConfig.minimumSpeed)
+		*speed = PWC_MoveConfig.minimumSpeed;   // Below this the motor stalls
+
+	return (output > 0)? UP : DOWN;
+#else
+	uint16_t position = PWC_GetPosition();
+	uint16_t remaining;
+
+	// Never reverse to correct an overshoot: stopping past the target ends the move
+	if (direction == UP) {
+		if (position >= target)
+			return OFF;
+		remaining = target - position;
+	} else {
+		if (position <= target)
+			return OFF;
+		remaining = position - target;
+	}
+
+	if (remaining <= PWC_MoveConfig.tolerance)
+		return OFF;
+
+	// Full speed, then a linear slow-down to the approach speed over the deceleration distance
+	if (remaining >= PWC_MoveConfig.decelerationDistance)
+		*speed = MOTOR_DEFAULT_SPEED;
+	else
+		*speed = PWC_MoveConfig.minimumSpeed + (uint8_t)(((MOTOR_DEFAULT_SPEED - PWC_MoveConfig.minimumSpeed)
+				* (uint32_t)remaining) / PWC_MoveConfig.decelerationDistance);
+
+	return direction;
+#endif
+}
+
+// A PWC_MoveTo() ended by a limit switch reached its target if it is within the tolerance
+static uint8_t PWC_MoveArrived(uint16_t target) {
+	uint16_t position = PWC_GetPosition();
+	uint16_t distance = (position > target)? (position - target) : (target - position);
 
-		xSemaphoreGive(xMotorMutex);
-		HAL_Delay(200);
+	return (distance <= PWC_MoveConfig.tolerance);
+}
+
+// Report the end of a PWC_MoveTo() to its requester
+static void PWC_MoveEnd(TaskHandle_t *notifyTask, uint32_t event) {
 
+	if (*notifyTask != NULL) {
+		xTaskNotify(*notifyTask, event, eSetBits);
+		*notifyTask = NULL;
 	}
 }
 
-void PassengerTask(void *pvParamters) {
-	int Mode = OFF;
+// Motor owner: arbitrates the posted commands and is the only task calling PWC_motorControl()
+void MotorTask(void *pvParameters) {
+	PWC_MotorCommand_TypeDef commands[PWC_SRC_NUM];
+	PWC_MotorCommand_TypeDef *motorCommand;
+	MotorControlCommand_e activeCommand = OFF;            // Request currently executed
+	PWC_CommandSource_e activeSource = PWC_SRC_PASSENGER; // Its owner (meaningful while activeCommand != OFF)
+	MotorControlCommand_e moveDirection = OFF;            // MOVE_TO: direction of the move
+	MotorControlCommand_e direction;
+	uint16_t moveTarget = 0;                              // MOVE_TO: target position
+	TaskHandle_t moveNotifyTask = NULL;                   // MOVE_TO: requester
+	uint8_t speed = MOTOR_DEFAULT_SPEED;
+	TickType_t moveStepTick = 0;                          // MOVE_TO: tick of the last trajectory step
+	TickType_t moveStepElapsed;
+	TimeOut_t travelStart;
+	TickType_t travelRemaining = 0;
+	TickType_t waitTicks;
+	uint32_t pending;
+	uint32_t source;
+	uint32_t latencyUs;
 
 	for (;;) {
 
-		xSemaphoreTake(xMotorMutex, portMAX_DELAY);
-
-		//Handle the Up Button
-		if (BUTTON_IsPressed(&PassengerUpButton)) {
-			Mode = UP;
-			xQueueSendToBack(xQueue, &Mode, 0);
-			vTaskDelay(400); // Debounce delay
-
-			if (BUTTON_IsPressed(&PassengerUpButton)) {  // Manual Mode
-				PWC_motorControl(UP);
-				while (BUTTON_IsPressed(&PassengerUpButton))
-					;
-				PWC_motorControl(OFF);
-			} else { // Automatic Mode
-				PWC_motorControl(UP);
-				while (!LimitSwitch_IsPressed(&LimitUpSwitch))
-					;
-				PWC_motorControl(OFF);
+		// The limit switch ISR ends a travel by itself: the request is over
+		if ((activeCommand != OFF) && (PWC_MotorCommand == OFF)) {
+			if (activeCommand == MOVE_TO)
+				PWC_MoveEnd(&moveNotifyTask, PWC_MoveArrived(moveTarget)? PWC_EVT_MOVE_DONE : PWC_EVT_MOVE_ABORTED);
+			activeCommand = OFF;
+		}
+
+		// Follow the trajectory of a PWC_MoveTo() at a fixed rate, whatever wakes the task
+		if ((activeCommand == MOVE_TO)
+				&& ((xTaskGetTickCount() - moveStepTick) >= pdMS_TO_TICKS(PWC_MOVE_PERIOD_MS))) {
+			moveStepTick += pdMS_TO_TICKS(PWC_MOVE_PERIOD_MS);
+			if ((xTaskGetTickCount() - moveStepTick) >= pdMS_TO_TICKS(PWC_MOVE_PERIOD_MS))
+				moveStepTick = xTaskGetTickCount();   // Late by more than a period: skip, do not burst
+
+			direction = PWC_MoveStep(moveTarget, moveDirection, &speed);
+			if (direction == OFF) {
+				PWC_motorControl(OFF, MOTOR_DEFAULT_SPEED);
+				activeCommand = OFF;
+				PWC_MoveEnd(&moveNotifyTask, PWC_EVT_MOVE_DONE);
+			} else if (direction != moveDirection) {
+				moveDirection = direction;            // Closed loop correcting an overshoot
+				PWC_motorControl(direction, speed);
+			} else {
+				PWC_motorSpeed(speed);
+			}
+		}
+
+		// Every travel is bounded in time in case a limit switch never triggers
+		waitTicks = portMAX_DELAY;
+		if (activeCommand != OFF) {
+			if (xTaskCheckForTimeOut(&travelStart, &travelRemaining) == pdTRUE) {
+				PWC_motorControl(OFF, MOTOR_DEFAULT_SPEED);
+				if (activeCommand == MOVE_TO)
+					PWC_MoveEnd(&moveNotifyTask, PWC_EVT_MOVE_ABORTED);
+				activeCommand = OFF;
+				PWC_TravelTimeouts++;
+			} else {
+				waitTicks = travelRemaining;
 			}
-			Mode = OFF;
-			xQueueSendToBack(xQueue, &Mode, 0);
 		}
 
-		//Handle the Down Button
-		if (BUTTON_IsPressed(&PassengerDownButton)) {
-			Mode = DOWN;
-			xQueueSendToBack(xQueue, &Mode, 0);
-			vTaskDelay(400); // Debounce delay
-
-			if (BUTTON_IsPressed(&PassengerDownButton)) {  // Manual Mode
-				PWC_motorControl(DOWN);
-				while (BUTTON_IsPressed(&PassengerDownButton))
-					;
-				PWC_motorControl(OFF);
-			} else { // Automatic Mode
-				PWC_motorControl(DOWN);
-				while (!LimitSwitch_IsPressed(&LimitDownSwitch))
-					;
-				PWC_motorControl(OFF);
+		// Sleep no longer than the next trajectory step
+		if (activeCommand == MOVE_TO) {
+			moveStepElapsed = xTaskGetTickCount() - moveStepTick;
+			if (moveStepElapsed >= pdMS_TO_TICKS(PWC_MOVE_PERIOD_MS))
+				waitTicks = 0;
+			else if (waitTicks > (pdMS_TO_TICKS(PWC_MOVE_PERIOD_MS) - moveStepElapsed))
+				waitTicks = pdMS_TO_TICKS(PWC_MOVE_PERIOD_MS) - moveStepElapsed;
+		}
+
+		PWC_MotorOwner = (activeCommand != OFF)? activeSource : PWC_SRC_NUM;
+
+		// Sleep until a command is posted (or the end of the travel time)
+		if (xTaskNotifyWait(0, PWC_EVT_ALL, NULL, waitTicks) != pdPASS)
+			continue;
+
+		// Take every pending slot at once
+		taskENTER_CRITICAL();
+		pending = PWC_MailboxPending;
+		PWC_MailboxPending = 0;
+		for (source = 0; source < PWC_SRC_NUM; source++)
+			commands[source] = PWC_Mailbox[source];
+		taskEXIT_CRITICAL();
+
+		if ((activeCommand != OFF) && (PWC_MotorCommand == OFF)) {
+			if (activeCommand == MOVE_TO)
+				PWC_MoveEnd(&moveNotifyTask, PWC_MoveArrived(moveTarget)? PWC_EVT_MOVE_DONE : PWC_EVT_MOVE_ABORTED);
+			activeCommand = OFF;
+		}
+
+		// Highest priority source first (jam > driver > passenger)
+		while (pending != 0) {
+			source = 31U - __CLZ(pending);
+			pending &= ~(1UL << source);
+			motorCommand = &commands[source];
+
+			// A lower source never overrides the active request, an equal or higher one preempts it.
+			// A PWC_MoveTo() is preempted by any new command
+			if ((activeCommand != OFF) && (activeCommand != MOVE_TO) && (motorCommand->source < activeSource)) {
+				PWC_RejectedCommands++;
+				continue;
+			}
+
+			if (activeCommand == MOVE_TO)
+				PWC_MoveEnd(&moveNotifyTask, PWC_EVT_MOVE_ABORTED);
+
+			if ((motorCommand->command != OFF)
+					&& ((motorCommand->command != activeCommand) || (motorCommand->command == MOVE_TO))) {
+				vTaskSetTimeOutState(&travelStart);   // New travel: restart the safety timeout
+				travelRemaining = pdMS_TO_TICKS(PWC_TRAVEL_TIMEOUT_MS);
+			}
+
+			activeCommand = motorCommand->command;
+			activeSource = motorCommand->source;
+
+			if (activeCommand == MOVE_TO) {
+				moveTarget = motorCommand->target;
+				moveNotifyTask = motorCommand->notifyTask;
+				moveDirection = (moveTarget > PWC_GetPosition())? UP : DOWN;
+				moveStepTick = xTaskGetTickCount();
+#if PWC_POSITION_COUNTED
+				Pid_Reset(&PWC_PositionPid);
+#endif
+
+				direction = PWC_MoveStep(moveTarget, moveDirection, &speed);
+				if (direction == OFF) {
+					// Already there
+					PWC_motorControl(OFF, MOTOR_DEFAULT_SPEED);
+					activeCommand = OFF;
+					PWC_MoveEnd(&moveNotifyTask, PWC_EVT_MOVE_DONE);
+				} else {
+					moveDirection = direction;
+					PWC_motorControl(direction, speed);
+				}
+			} else {
+				PWC_motorControl(activeCommand, MOTOR_DEFAULT_SPEED);
 			}
-			Mode = OFF;
-			xQueueSendToBack(xQueue, &Mode, 0);
+
+			// Command-to-output latency (posting + arbitration + output write)
+			latencyUs = CycleCounter_ToMicroseconds(CycleCounter_Get() - motorCommand->timestamp);
+			PWC_CommandLatencyUs = latencyUs;
+			if (latencyUs > PWC_CommandLatencyMaxUs)
+				PWC_CommandLatencyMaxUs = latencyUs;
 		}
+	}
+}
 
-		xSemaphoreGive(xMotorMutex);
-		HAL_Delay(200);
-		//timer0_Delay(200); // Task delay
+// Window panel (driver or passenger, see PWC_Panels): one state machine dispatch per button edge
+void PanelTask(void *pvParameters) {
+	const PWC_Panel_TypeDef *panel = (const PWC_Panel_TypeDef *)pvParameters;
+	uint32_t events;
+
+	WindowFsm_Init(panel->fsm);
+
+	for (;;) {
 
+		// Sleep until a button edge of this panel is delivered by Debounce_EdgeCallback()
+		// (or a lock switch change from LockPassengerTask)
+		xTaskNotifyWait(0, PWC_EVT_ALL, &events, portMAX_DELAY);
+
+		PWC_PanelSync(panel);
+
+		PWC_PanelButton(panel, panel->upPress, events, PWC_EVT_UP_PRESS, PWC_EVT_UP_RELEASE,
+				WINDOW_EVT_UP_PRESS, WINDOW_EVT_UP_RELEASE_SHORT, WINDOW_EVT_UP_RELEASE_LONG,
+				WINDOW_EVT_UP_RELEASE_DOUBLE);
+		PWC_PanelButton(panel, panel->downPress, events, PWC_EVT_DOWN_PRESS, PWC_EVT_DOWN_RELEASE,
+				WINDOW_EVT_DOWN_PRESS, WINDOW_EVT_DOWN_RELEASE_SHORT, WINDOW_EVT_DOWN_RELEASE_LONG,
+				WINDOW_EVT_DOWN_RELEASE_DOUBLE);
 	}
 }
 
+// Replay the pending edges of one button in their order. The release is classified by the
+// interrupt from the press and release timestamps, not from the level seen by the task, so a
+// tap shorter than the task wake-up still gives a press then a short release.
+static void PWC_PanelButton(const PWC_Panel_TypeDef *panel, PressClassifier_TypeDef *classifier, uint32_t events,
+		uint32_t pressEvent, uint32_t releaseEvent, WindowFsm_Event_e press, WindowFsm_Event_e releaseShort,
+		WindowFsm_Event_e releaseLong, WindowFsm_Event_e releaseDouble) {
+	PressType_e type = PressClassifier_GetLast(classifier);
+	WindowFsm_Event_e release = (type == PRESS_LONG)? releaseLong : (type == PRESS_DOUBLE)? releaseDouble : releaseShort;
+	uint8_t held = PressClassifier_IsHeld(classifier);
+
+	// Held again: the pending release ended the previous press
+	if ((events & releaseEvent) && held)
+		PWC_PanelAction(panel, WindowFsm_Dispatch(panel->fsm, release));
+
+	if (events & pressEvent)
+		PWC_PanelAction(panel, WindowFsm_Dispatch(panel->fsm, press));
+
+	if ((events & releaseEvent) && !held)
+		PWC_PanelAction(panel, WindowFsm_Dispatch(panel->fsm, release));
+}
+
+// Dispatch the conditions that changed since the last button edge of the panel (jam reversal,
+// lock switch, end of its travel), so the state machine is current without polling
+static void PWC_PanelSync(const PWC_Panel_TypeDef *panel) {
+	WindowFsm_TypeDef *fsm = panel->fsm;
+
+	if (PWC_JamState == PWC_JAM_REVERSING)
+		WindowFsm_Dispatch(fsm, WINDOW_EVT_JAM);
+	else if (fsm->state == WINDOW_STATE_JAM_REVERSE)
+		WindowFsm_Dispatch(fsm, WINDOW_EVT_JAM_END);
+
+	if (WindowFsm_IsMoving(fsm->state) && ((PWC_MotorCommand == OFF) || (PWC_MotorOwner != panel->source)))
+		WindowFsm_Dispatch(fsm, WINDOW_EVT_TRAVEL_END);   // Limit switch, timeout or preempted
+
+	// After the travel check: a lock stops the motor only if this panel still owns the travel
+	// (its release edges are dropped while locked)
+	if (panel->lockable)
+		PWC_PanelAction(panel, WindowFsm_Dispatch(fsm, (xEventGroupGetBits(xWindowEvents) & PWC_INHIBIT_PASSENGER)?
+				WINDOW_EVT_LOCK : WINDOW_EVT_UNLOCK));
+}
+
+// Send the motor command of a transition on behalf of the panel
+static void PWC_PanelAction(const PWC_Panel_TypeDef *panel, WindowFsm_Action_e action) {
+	static const MotorControlCommand_e commands[] = {
+		[WINDOW_ACTION_UP] = UP, [WINDOW_ACTION_DOWN] = DOWN, [WINDOW_ACTION_STOP] = OFF
+	};
+
+	if (action != WINDOW_ACTION_NONE)
+		PWC_SendCommand(panel->source, commands[action]);
+}
+
 void EXTI_Initialization() {
-	//lock
+	//lock: both edges, engaging the switch (pulled up) gives the falling one
 	exti_configA.Line = EXTI_LINE_2;
 	exti_configA.Mode = EXTI_MODE_INTERRUPT;
-	exti_configA.Trigger = EXTI_TRIGGER_RISING;
+	exti_configA.Trigger = EXTI_TRIGGER_RISING_FALLING;
 	exti_configA.GPIOSel = EXTI_GPIOD;
 
 //jam
@@ -370,41 +1304,108 @@ void EXTI_Initialization() {
 	exti_configB.GPIOSel = EXTI_GPIOD;
 }
 
-void EXTI2_IRQHandler(void) {
+// Raw button edge: only (re)start the debouncer, the tasks are woken on debounced edges
+static void PWC_ButtonEdge(void *context) {
+	BUTTON_TypeDef *button = (BUTTON_TypeDef *)context;
 
-	HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_2);
-	HAL_EXTI_IRQHandler(&hextiA);
+	if (Debounce_Start() && BUTTON_IsPressed(button))
+		PWC_PressTimestamp = CycleCounter_Get();  // First press edge: start the latency measurement
 }
 
-void EXTI3_IRQHandler(void) {
+// Feed a debounced edge of one button to its press classifier
+static void PWC_ClassifyEdge(PressClassifier_TypeDef *classifier, BUTTON_TypeDef *button,
+		uint32_t pressed, uint32_t released, uint32_t timestamp) {
+	uint32_t mask = PWC_ButtonMask(button);
 
-	HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_3);
-	HAL_EXTI_IRQHandler(&hextiB);
+	if ((pressed | released) & mask)
+		PressClassifier_OnEdge(classifier, ((pressed & mask) != 0), timestamp);
 }
 
-void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+// Debounced edges (TIM7 interrupt): classify them and wake the task owning each button that changed
+void Debounce_EdgeCallback(uint32_t pressed, uint32_t released) {
+	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+	uint32_t timestamp = CycleCounter_Get();
+	const PWC_Panel_TypeDef *panel;
+	EventBits_t inhibit = (xWindowEvents != NULL)? xEventGroupGetBitsFromISR(xWindowEvents) : 0;
+	uint32_t events;
+
+	for (panel = &PWC_Panels[0]; panel < &PWC_Panels[PWC_PANEL_NUM]; panel++) {
+		// Locked panel: drop its input here, its task is not even woken
+		if (panel->lockable && (inhibit & PWC_INHIBIT_PASSENGER))
+			continue;
+
+		// Classify before waking the task so the result is ready when it sees the release
+		PWC_ClassifyEdge(panel->upPress, panel->upButton, pressed, released, timestamp);
+		PWC_ClassifyEdge(panel->downPress, panel->downButton, pressed, released, timestamp);
+
+		events = 0;
+		if (pressed & PWC_ButtonMask(panel->upButton))
+			events |= PWC_EVT_UP_PRESS;
+		if (released & PWC_ButtonMask(panel->upButton))
+			events |= PWC_EVT_UP_RELEASE;
+		if (pressed & PWC_ButtonMask(panel->downButton))
+			events |= PWC_EVT_DOWN_PRESS;
+		if (released & PWC_ButtonMask(panel->downButton))
+			events |= PWC_EVT_DOWN_RELEASE;
+
+		// Edges may arrive before the tasks are created
+		if ((events != 0) && (*panel->task != NULL))
+			xTaskNotifyFromISR(*panel->task, events, eSetBits, &xHigherPriorityTaskWoken);
+	}
 
-// this is what you want to do when the interrupt happen
+	portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
 
-	if (GPIO_Pin == GPIO_PIN_2) {
-		// lock button
+// Limit switch edge (EXTI0/1, priority 5)
+static void PWC_LimitSwitchEdge(void *context) {
 
-		portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
-		xSemaphoreGiveFromISR(xLockSemaphore, &xHigherPriorityTaskWoken); // Give lock semaphore from ISR
-		portEND_SWITCHING_ISR(xHigherPriorityTaskWoken); // End ISR, possibly switching to a higher priority task
-	}
+	LimitSwitch_IRQHandler((LimitSwitch_TypeDef *)context);
+}
 
-	else if (GPIO_Pin == GPIO_PIN_3) {
-		//Jam button
-		portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
-		xSemaphoreGiveFromISR(xJamSemaphore, &xHigherPriorityTaskWoken); // Give binary semaphore from ISR
-		portEND_SWITCHING_ISR(xHigherPriorityTaskWoken); // End ISR, possibly switching to a higher priority task
-	}
+// Lock switch edge (EXTI2, engaged or released): wake the lock task, which reads the level
+static void PWC_LockEdge(void *context) {
+	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+	(void)context;
+
+	if (LockHandle != NULL)
+		xTaskNotifyFromISR(LockHandle, PWC_EVT_LOCK_SWITCH, eSetBits, &xHigherPriorityTaskWoken);
+	portEND_SWITCHING_ISR(xHigherPriorityTaskWoken); // End ISR, possibly switching to a higher priority task
+}
+
+#if PWC_JAM_BUTTON_ENABLED
+// Jam button edge (EXTI3)
+static void PWC_JamEdge(void *context) {
+	uint32_t timestamp = CycleCounter_Get();
+	UBaseType_t uxSavedInterruptStatus;
+
+	(void)context;
+
+	// EXTI3 runs below the motor interrupts (priority 5): mask them while the motor state changes
+	uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+	PWC_JamStop(timestamp);
+	taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+#endif
+
+#if PWC_SIGNAL_BENCHMARK
+// Signalling benchmark trigger (EXTI4 software interrupt)
+static void PWC_SignalBenchEdge(void *context) {
+
+	(void)context;
 
+	SignalBench_IRQHandler();
 }
+#endif
 
 static void MX_NVIC_Init(void) {
 
+	//limit switches (highest application priority: they cut the motor)
+	HAL_NVIC_SetPriority(EXTI0_IRQn, 5, 0);
+	HAL_NVIC_EnableIRQ(EXTI0_IRQn);
+	HAL_NVIC_SetPriority(EXTI1_IRQn, 5, 0);
+	HAL_NVIC_EnableIRQ(EXTI1_IRQn);
+
 	//lock
 	HAL_NVIC_SetPriority(EXTI2_IRQn, 7, 7);
 	HAL_NVIC_EnableIRQ(EXTI2_IRQn);
@@ -413,6 +1414,12 @@ static void MX_NVIC_Init(void) {
 	HAL_NVIC_SetPriority(EXTI3_IRQn, 6, 6);
 	HAL_NVIC_EnableIRQ(EXTI3_IRQn);
 
+	//window buttons (PD9 / PB10, PB11, PB12)
+	HAL_NVIC_SetPriority(EXTI9_5_IRQn, 8, 0);
+	HAL_NVIC_EnableIRQ(EXTI9_5_IRQn);
+	HAL_NVIC_SetPriority(EXTI15_10_IRQn, 8, 0);
+	HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
+
 }
 
 
@@ -471,22 +1478,6 @@ static void MX_GPIO_Init(void) {
 
 /* USER CODE END 4 */
 
-/* USER CODE BEGIN Header_StartDefaultTask */
-/**
- * @brief  Function implementing the defaultTask thread.
- * @param  argument: Not used
- * @retval None
- */
-/* USER CODE END Header_StartDefaultTask */
-void StartDefaultTask(void const *argument) {
-	/* USER CODE BEGIN 5 */
-	/* Infinite loop */
-	for (;;) {
-		osDelay(1);
-	}
-	/* USER CODE END 5 */
-}
-
 /**
  * @brief  This function is executed in case of error occurrence.
  * @retval None
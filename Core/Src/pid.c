@@ -0,0 +1,106 @@
+/******************************************************************************
+ *
+ * Module: PID
+ *
+ * File Name: pid.c
+ *
+ * Description: Source file for the fixed-point PID controller.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#include "pid.h"
+#include <stddef.h>
+
+/*******************************************************************************
+ *                           Private Functions                                 *
+ *******************************************************************************/
+
+static int32_t Pid_Clamp(int32_t value, int32_t minimum, int32_t maximum)
+{
+    if (value < minimum)
+        return minimum;
+    if (value > maximum)
+        return maximum;
+    return value;
+}
+
+/*******************************************************************************
+ *                           Functions Definitions                             *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize a controller.
+ *
+ * Parameters:
+ * - pid: Pointer to the controller instance.
+ * - config: Pointer to the gains and output limits (kept by reference).
+ *
+ * Return:
+ * - None
+ */
+void Pid_Init(Pid_TypeDef *pid, const Pid_ConfigTypeDef *config)
+{
+    if (pid == NULL)
+        return;
+
+    pid->config = config;
+    Pid_Reset(pid);
+}
+
+/*
+ * Description :
+ * Clear the integral and derivative history.
+ */
+void Pid_Reset(Pid_TypeDef *pid)
+{
+    if (pid == NULL)
+        return;
+
+    pid->integral = 0;
+    pid->previousError = 0;
+    pid->first = 1;
+}
+
+/*
+ * Description :
+ * Run one loop period.
+ *
+ * Parameters:
+ * - pid: Pointer to the controller instance.
+ * - error: Set point minus measurement.
+ *
+ * Return:
+ * - int32_t: Controller output, within [outputMin, outputMax].
+ */
+int32_t Pid_Update(Pid_TypeDef *pid, int32_t error)
+{
+    const Pid_ConfigTypeDef *config;
+    int64_t output;
+
+    if ((pid == NULL) || (pid->config == NULL))
+        return 0;
+
+    config = pid->config;
+    error = Pid_Clamp(error, -PID_ERROR_LIMIT, PID_ERROR_LIMIT);
+
+    /* Anti-windup: the integral alone never exceeds the output range */
+    pid->integral = Pid_Clamp(pid->integral + (config->ki * error),
+                              config->outputMin * PID_GAIN_ONE, config->outputMax * PID_GAIN_ONE);
+
+    output = ((int64_t)config->kp * error) + pid->integral;
+    if (!pid->first)
+        output += (int64_t)config->kd * (error - pid->previousError);
+
+    pid->previousError = error;
+    pid->first = 0;
+
+    output /= PID_GAIN_ONE;
+    if (output < config->outputMin)
+        return config->outputMin;
+    if (output > config->outputMax)
+        return config->outputMax;
+    return (int32_t)output;
+}
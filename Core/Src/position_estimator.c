@@ -0,0 +1,214 @@
+/******************************************************************************
+ *
+ * Module: POSITION ESTIMATOR
+ *
+ * File Name: position_estimator.c
+ *
+ * Description: Source file for the sensorless window position estimator
+ *              (dead reckoning of the motor run time, calibrated by the limit switches).
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#include "position_estimator.h"
+#include "cycle_counter.h"
+
+/*******************************************************************************
+ *                           Private Functions                                 *
+ *******************************************************************************/
+
+/* Run time at full speed equivalent to elapsedUs at the segment speed */
+static uint32_t PositionEstimator_FullSpeedUs(const PositionEstimator_TypeDef *estimator, uint32_t elapsedUs)
+{
+    return (uint32_t)(((uint64_t)elapsedUs * estimator->speed) / 100U);
+}
+
+/* Signed distance covered by elapsedUs (at full speed) of the given motion */
+static int32_t PositionEstimator_Distance(const PositionEstimator_TypeDef *estimator,
+                                          PositionMotion_e motion, uint32_t elapsedUs)
+{
+    uint32_t travelUs = (motion == POSITION_MOVING_UP)? estimator->travelUpUs : estimator->travelDownUs;
+    uint64_t distance;
+
+    if ((motion == POSITION_STOPPED) || (travelUs == 0))
+        return 0;
+
+    distance = ((uint64_t)elapsedUs * (uint64_t)POSITION_FULL_SCALE) / travelUs;
+    if (distance > (uint64_t)POSITION_FULL_SCALE)
+        distance = (uint64_t)POSITION_FULL_SCALE;
+
+    return (motion == POSITION_MOVING_UP)? (int32_t)distance : -(int32_t)distance;
+}
+
+static int32_t PositionEstimator_Clamp(int32_t position)
+{
+    if (position < 0)
+        return 0;
+    if (position > POSITION_FULL_SCALE)
+        return POSITION_FULL_SCALE;
+    return position;
+}
+
+/* Close the running motion segment at timestamp */
+static void PositionEstimator_Integrate(PositionEstimator_TypeDef *estimator, uint32_t timestamp)
+{
+    uint32_t elapsedUs;
+
+    if (estimator->motion != POSITION_STOPPED)
+    {
+        elapsedUs = PositionEstimator_FullSpeedUs(estimator,
+                CycleCounter_ToMicroseconds(timestamp - estimator->motionTimestamp));
+
+        estimator->position = PositionEstimator_Clamp(estimator->position
+                + PositionEstimator_Distance(estimator, estimator->motion, elapsedUs));
+
+        /* A calibration run must keep one direction from one limit switch to the other */
+        if (estimator->calibrating)
+        {
+            if (estimator->calibrationMotion == POSITION_STOPPED)
+                estimator->calibrationMotion = estimator->motion;
+
+            if (estimator->calibrationMotion == estimator->motion)
+                estimator->calibrationUs += elapsedUs;
+            else
+                estimator->calibrating = 0;
+        }
+    }
+
+    estimator->motionTimestamp = timestamp;
+}
+
+/*******************************************************************************
+ *                           Functions Definitions                             *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize an estimator with default full travel times.
+ *
+ * Parameters:
+ * - estimator: Pointer to the estimator instance.
+ * - travelUpUs: Default bottom -> top travel time, in microseconds.
+ * - travelDownUs: Default top -> bottom travel time, in microseconds.
+ *
+ * Return:
+ * - None
+ */
+void PositionEstimator_Init(PositionEstimator_TypeDef *estimator, uint32_t travelUpUs, uint32_t travelDownUs)
+{
+    if (estimator == NULL)
+        return;
+
+    estimator->travelUpUs = travelUpUs;
+    estimator->travelDownUs = travelDownUs;
+    estimator->position = POSITION_FULL_SCALE / 2;
+    estimator->motion = POSITION_STOPPED;
+    estimator->speed = 100U;
+    estimator->motionTimestamp = 0;
+    estimator->referenced = 0;
+    estimator->calibrating = 0;
+    estimator->calibrationLimit = POSITION_LIMIT_BOTTOM;
+    estimator->calibrationMotion = POSITION_STOPPED;
+    estimator->calibrationUs = 0;
+}
+
+/*
+ * Description :
+ * Report a change of motor motion or speed.
+ *
+ * Parameters:
+ * - estimator: Pointer to the estimator instance.
+ * - motion: New motion.
+ * - speed: New speed in percent of the full (calibration) speed.
+ * - timestamp: CycleCounter_Get() value of the change.
+ *
+ * Return:
+ * - None
+ */
+void PositionEstimator_OnMotion(PositionEstimator_TypeDef *estimator, PositionMotion_e motion, uint8_t speed,
+                               uint32_t timestamp)
+{
+    if (estimator == NULL)
+        return;
+
+    PositionEstimator_Integrate(estimator, timestamp);
+    estimator->motion = motion;
+    estimator->speed = (speed > 100U)? 100U : speed;
+}
+
+/*
+ * Description :
+ * Report a touched limit switch.
+ *
+ * Parameters:
+ * - estimator: Pointer to the estimator instance.
+ * - limit: Touched limit switch.
+ * - timestamp: CycleCounter_Get() value of the touch.
+ *
+ * Return:
+ * - None
+ */
+void PositionEstimator_OnLimit(PositionEstimator_TypeDef *estimator, PositionLimit_e limit, uint32_t timestamp)
+{
+    if (estimator == NULL)
+        return;
+
+    PositionEstimator_Integrate(estimator, timestamp);
+
+    /* Full travel from the other limit switch in one direction: recalibrate that direction */
+    if (estimator->calibrating && (estimator->calibrationLimit != limit) && (estimator->calibrationUs != 0))
+    {
+        if ((limit == POSITION_LIMIT_TOP) && (estimator->calibrationMotion == POSITION_MOVING_UP))
+            estimator->travelUpUs = estimator->calibrationUs;
+        else if ((limit == POSITION_LIMIT_BOTTOM) && (estimator->calibrationMotion == POSITION_MOVING_DOWN))
+            estimator->travelDownUs = estimator->calibrationUs;
+    }
+
+    estimator->position = (limit == POSITION_LIMIT_TOP)? POSITION_FULL_SCALE : 0;
+    estimator->referenced = 1;
+
+    /* Start a new calibration run from this limit switch */
+    estimator->calibrating = 1;
+    estimator->calibrationLimit = limit;
+    estimator->calibrationMotion = POSITION_STOPPED;
+    estimator->calibrationUs = 0;
+}
+
+/*
+ * Description :
+ * Return the estimated position, including the running motion segment.
+ *
+ * Parameters:
+ * - estimator: Pointer to the estimator instance.
+ * - timestamp: CycleCounter_Get() value to estimate the position at.
+ *
+ * Return:
+ * - uint16_t: Position in 0.1 % of the full travel (0 = bottom, 1000 = top).
+ */
+uint16_t PositionEstimator_Get(const PositionEstimator_TypeDef *estimator, uint32_t timestamp)
+{
+    int32_t position;
+
+    if (estimator == NULL)
+        return 0;
+
+    position = estimator->position;
+    if (estimator->motion != POSITION_STOPPED)
+    {
+        position = PositionEstimator_Clamp(position + PositionEstimator_Distance(estimator, estimator->motion,
+                PositionEstimator_FullSpeedUs(estimator,
+                        CycleCounter_ToMicroseconds(timestamp - estimator->motionTimestamp))));
+    }
+
+    return (uint16_t)(position / POSITION_PERMILLE_DIVIDER);
+}
+
+/*
+ * Description :
+ * Return 1 once a limit switch has been touched.
+ */
+uint8_t PositionEstimator_IsReferenced(const PositionEstimator_TypeDef *estimator)
+{
+    return (estimator != NULL)? estimator->referenced : 0;
+}
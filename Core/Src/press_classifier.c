@@ -0,0 +1,124 @@
+/******************************************************************************
+ *
+ * Module: PRESS CLASSIFIER
+ *
+ * File Name: press_classifier.c
+ *
+ * Description: Source file for the button press-duration classifier
+ *              (short / long / double press).
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#include "press_classifier.h"
+
+/*******************************************************************************
+ *                           Functions Definitions                             *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize a classifier instance with the thresholds of its panel.
+ *
+ * Parameters:
+ * - classifier: Pointer to the classifier instance.
+ * - config: Pointer to the panel thresholds.
+ *
+ * Return:
+ * - None
+ */
+void PressClassifier_Init(PressClassifier_TypeDef *classifier, const PressClassifier_ConfigTypeDef *config)
+{
+    uint32_t cyclesPerMicrosecond = SystemCoreClock / 1000000U;
+
+    if ((classifier == NULL) || (config == NULL))
+        return;
+
+    classifier->longPressCycles = config->longPressUs * cyclesPerMicrosecond;
+    classifier->doublePressGapCycles = config->doublePressGapUs * cyclesPerMicrosecond;
+    classifier->pressTimestamp = 0;
+    classifier->releaseTimestamp = 0;
+    classifier->previousShort = 0;
+    classifier->held = 0;
+    classifier->lastType = PRESS_NONE;
+}
+
+/*
+ * Description :
+ * Feed one (debounced) edge of the button.
+ *
+ * Parameters:
+ * - classifier: Pointer to the classifier instance.
+ * - pressed: 1 for a press edge, 0 for a release edge.
+ * - timestamp: CycleCounter_Get() value of the edge.
+ *
+ * Return:
+ * - PressType_e: PRESS_NONE for a press edge, the classification for a release edge.
+ */
+PressType_e PressClassifier_OnEdge(PressClassifier_TypeDef *classifier, uint8_t pressed, uint32_t timestamp)
+{
+    PressType_e type;
+
+    if (classifier == NULL)
+        return PRESS_NONE;
+
+    if (pressed)
+    {
+        classifier->pressTimestamp = timestamp;
+        classifier->held = 1;
+        return PRESS_NONE;
+    }
+
+    /* Unsigned differences stay correct across one wrap of the cycle counter */
+    if ((timestamp - classifier->pressTimestamp) >= classifier->longPressCycles)
+        type = PRESS_LONG;
+    else if ((classifier->previousShort) &&
+             ((classifier->pressTimestamp - classifier->releaseTimestamp) <= classifier->doublePressGapCycles))
+        type = PRESS_DOUBLE;
+    else
+        type = PRESS_SHORT;
+
+    classifier->releaseTimestamp = timestamp;
+    classifier->previousShort = (type == PRESS_SHORT);   // A double press does not chain into another one
+    classifier->lastType = type;
+    classifier->held = 0;
+
+    return type;
+}
+
+/*
+ * Description :
+ * Return the classification of the last complete press.
+ *
+ * Parameters:
+ * - classifier: Pointer to the classifier instance.
+ *
+ * Return:
+ * - PressType_e: PRESS_NONE before the first complete press.
+ */
+PressType_e PressClassifier_GetLast(PressClassifier_TypeDef *classifier)
+{
+    if (classifier == NULL)
+        return PRESS_NONE;
+
+    return classifier->lastType;
+}
+
+/*
+ * Description :
+ * Return whether the last edge fed to the classifier was a press.
+ *
+ * Parameters:
+ * - classifier: Pointer to the classifier instance.
+ *
+ * Return:
+ * - uint8_t: 1 while the button is held.
+ */
+uint8_t PressClassifier_IsHeld(PressClassifier_TypeDef *classifier)
+{
+    if (classifier == NULL)
+        return 0;
+
+    return classifier->held;
+}
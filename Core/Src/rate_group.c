@@ -0,0 +1,103 @@
+/******************************************************************************
+ *
+ * Module: RATE GROUP
+ *
+ * File Name: rate_group.c
+ *
+ * Description: Source file for the fixed-rate executive.
+ *
+ *   Releases are absolute (vTaskDelayUntil), so the rate does not drift with the
+ *   execution time of the jobs. The time between two releases is measured with
+ *   the DWT cycle counter: its deviation from the period is the jitter caused by
+ *   higher priority tasks and interrupts.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#include "rate_group.h"
+#include "cycle_counter.h"
+
+/*******************************************************************************
+ *                           Private Functions                                 *
+ *******************************************************************************/
+
+static void RateGroup_Task(void *pvParameters)
+{
+    RateGroup_TypeDef *group = (RateGroup_TypeDef *)pvParameters;
+    const RateGroup_ConfigTypeDef *config = group->config;
+    const TickType_t period = pdMS_TO_TICKS(config->periodMs);
+    const uint32_t periodCycles = (SystemCoreClock / 1000U) * config->periodMs;
+    TickType_t lastWake = xTaskGetTickCount();
+    uint32_t lastRelease = 0;
+    uint8_t measureJitter = 0;
+    uint32_t release;
+    uint32_t interval;
+    uint32_t us;
+    uint8_t i;
+
+    for (;;)
+    {
+        vTaskDelayUntil(&lastWake, period);
+
+        release = CycleCounter_Get();
+        if (measureJitter)
+        {
+            interval = release - lastRelease;
+            us = CycleCounter_ToMicroseconds((interval > periodCycles)? (interval - periodCycles) : (periodCycles - interval));
+            group->jitterUs = us;
+            if (us > group->maxJitterUs)
+                group->maxJitterUs = us;
+        }
+        lastRelease = release;
+        measureJitter = 1;
+
+        for (i = 0; i < config->numJobs; i++)
+            config->jobs[i]();
+
+        group->activations++;
+        us = CycleCounter_ToMicroseconds(CycleCounter_Get() - release);
+        group->executionUs = us;
+        if (us > group->maxExecutionUs)
+            group->maxExecutionUs = us;
+
+        /* The next release is already due: count it and restart from now */
+        if ((xTaskGetTickCount() - lastWake) >= period)
+        {
+            group->overruns++;
+            lastWake = xTaskGetTickCount();
+            measureJitter = 0;
+        }
+    }
+}
+
+/*******************************************************************************
+ *                           Functions Definitions                             *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Create the task of a rate group.
+ *
+ * Parameters:
+ * - group: Pointer to the rate group instance (statistics).
+ * - config: Pointer to the group declaration (kept by reference).
+ *
+ * Return:
+ * - BaseType_t: pdPASS if the task was created.
+ */
+BaseType_t RateGroup_Create(RateGroup_TypeDef *group, const RateGroup_ConfigTypeDef *config)
+{
+    if ((group == NULL) || (config == NULL) || (config->periodMs == 0))
+        return pdFAIL;
+
+    group->config = config;
+    group->activations = 0;
+    group->overruns = 0;
+    group->jitterUs = 0;
+    group->maxJitterUs = 0;
+    group->executionUs = 0;
+    group->maxExecutionUs = 0;
+
+    return xTaskCreate(RateGroup_Task, config->name, config->stackWords, group, config->priority, &group->task);
+}
@@ -0,0 +1,228 @@
+/******************************************************************************
+ *
+ * Module: RIPPLE COUNTER
+ *
+ * File Name: ripple_counter.c
+ *
+ * Description: Source file for the sensorless ripple counter.
+ *
+ *   Each commutation of the brushed motor leaves a ripple on the motor current.
+ *   The samples are moved around their DC level (tracked from the block means),
+ *   low-pass filtered below the 20 kHz PWM and ADC noise, and every positive
+ *   excursion above the hysteresis that follows a negative one counts as a ripple.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#include "ripple_counter.h"
+#include "cycle_counter.h"
+
+/*******************************************************************************
+ *                           Private Variables                                 *
+ *******************************************************************************/
+
+/* FIR low-pass, 2 kHz cut-off at 20 kHz (Hamming window), Q15, unity DC gain,
+ * packed by pairs for __SMLAD. The taps are symmetric: no reversal needed. */
+static const uint32_t RippleCounter_Taps[RIPPLE_COUNTER_TAPS / 2U] = {
+    (uint16_t)-114  | ((uint32_t)(uint16_t)-159 << 16),
+    (uint16_t)-139  | ((uint32_t)(uint16_t)291  << 16),
+    (uint16_t)1450  | ((uint32_t)(uint16_t)3284 << 16),
+    (uint16_t)5246  | ((uint32_t)(uint16_t)6525 << 16),
+    (uint16_t)6525  | ((uint32_t)(uint16_t)5246 << 16),
+    (uint16_t)3284  | ((uint32_t)(uint16_t)1450 << 16),
+    (uint16_t)291   | ((uint32_t)(uint16_t)-139 << 16),
+    (uint16_t)-159  | ((uint32_t)(uint16_t)-114 << 16),
+};
+
+static const RippleCounter_ConfigTypeDef *RippleCounter_Config;
+
+/* Filter input: the last RIPPLE_COUNTER_TAPS - 1 samples of the previous block, then the new block */
+static int16_t RippleCounter_Window[RIPPLE_COUNTER_TAPS - 1U + RIPPLE_COUNTER_MAX_BLOCK];
+
+static int32_t RippleCounter_DcLevel;           // Tracked DC level << RIPPLE_COUNTER_DC_SHIFT
+static uint8_t RippleCounter_High;              // Peak detector state: above +hysteresis
+static uint32_t RippleCounter_SamplesSincePeak;
+static volatile int32_t RippleCounter_Count;
+static volatile uint32_t RippleCounter_PeriodSamples;   // Samples between the last two peaks (0 = none)
+static volatile uint32_t RippleCounter_ProcessCycles;
+static volatile uint32_t RippleCounter_ProcessMaxCycles;
+
+/*******************************************************************************
+ *                           Functions Definitions                             *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize the ripple counter.
+ *
+ * Parameters:
+ * - config: Pointer to the detector settings (kept by reference).
+ *
+ * Return:
+ * - None
+ */
+void RippleCounter_Init(const RippleCounter_ConfigTypeDef *config)
+{
+    uint32_t i;
+
+    RippleCounter_Config = config;
+
+    for (i = 0; i < (RIPPLE_COUNTER_TAPS - 1U + RIPPLE_COUNTER_MAX_BLOCK); i++)
+        RippleCounter_Window[i] = 0;
+
+    RippleCounter_DcLevel = 0;
+    RippleCounter_High = 0;
+    RippleCounter_SamplesSincePeak = 0;
+    RippleCounter_Count = 0;
+    RippleCounter_PeriodSamples = 0;
+    RippleCounter_ProcessCycles = 0;
+    RippleCounter_ProcessMaxCycles = 0;
+}
+
+/*
+ * Description :
+ * Process one block of raw 12-bit current samples.
+ *
+ * Parameters:
+ * - block: Samples (from the current sense DMA buffer).
+ * - size: Number of samples, even and at most RIPPLE_COUNTER_MAX_BLOCK.
+ * - direction: +1 / -1 while the motor is driven up / down, 0 while stopped.
+ *
+ * Return:
+ * - None
+ */
+void RippleCounter_ProcessBlock(const volatile uint16_t *block, uint32_t size, int8_t direction)
+{
+    int16_t *input = &RippleCounter_Window[RIPPLE_COUNTER_TAPS - 1U];
+    uint32_t start = CycleCounter_Get();
+    uint32_t minusDc;
+    uint32_t pair;
+    uint32_t sum = 0;
+    uint32_t i;
+    uint32_t k;
+    int32_t accumulator;
+    int32_t filtered;
+    int16_t hysteresis;
+
+    if ((RippleCounter_Config == NULL) || (size == 0) || (size > RIPPLE_COUNTER_MAX_BLOCK) || (size & 1U))
+        return;
+
+    hysteresis = RippleCounter_Config->hysteresis;
+
+    /* Remove the DC level, two samples per __QADD16 */
+    minusDc = (uint16_t)(int16_t)-(RippleCounter_DcLevel >> RIPPLE_COUNTER_DC_SHIFT);
+    minusDc |= minusDc << 16;
+
+    for (i = 0; i < size; i += 2U)
+    {
+        sum += (uint32_t)block[i] + block[i + 1U];
+        pair = __QADD16(__PKHBT(block[i], block[i + 1U], 16), minusDc);
+        input[i] = (int16_t)pair;
+        input[i + 1U] = (int16_t)(pair >> 16);
+    }
+
+    /* The DC tracker follows the block means (high-pass part of the band-pass) */
+    RippleCounter_DcLevel += (int32_t)(sum / size) - (RippleCounter_DcLevel >> RIPPLE_COUNTER_DC_SHIFT);
+
+    for (i = 0; i < size; i++)
+    {
+        /* FIR low-pass: two taps per __SMLAD */
+        const int16_t *x = &RippleCounter_Window[i];
+
+        accumulator = 0;
+        for (k = 0; k < (RIPPLE_COUNTER_TAPS / 2U); k++)
+            accumulator = (int32_t)__SMLAD(__PKHBT(x[2U * k], x[(2U * k) + 1U], 16),
+                                           RippleCounter_Taps[k], (uint32_t)accumulator);
+        filtered = accumulator >> 15;
+
+        /* Hysteresis peak detector: one count per ripple period */
+        RippleCounter_SamplesSincePeak++;
+        if (!RippleCounter_High && (filtered > hysteresis))
+        {
+            RippleCounter_High = 1;
+            if (RippleCounter_SamplesSincePeak >= RippleCounter_Config->minimumPeriod)
+            {
+                RippleCounter_PeriodSamples = RippleCounter_SamplesSincePeak;
+                RippleCounter_SamplesSincePeak = 0;
+                RippleCounter_Count += direction;
+            }
+        }
+        else if (RippleCounter_High && (filtered < -hysteresis))
+        {
+            RippleCounter_High = 0;
+        }
+    }
+
+    /* No ripple for a long time: the motor stands still */
+    if (RippleCounter_SamplesSincePeak > RippleCounter_Config->sampleRateHz / 10U)
+        RippleCounter_PeriodSamples = 0;
+
+    /* Keep the filter history for the next block */
+    for (k = 0; k < (RIPPLE_COUNTER_TAPS - 1U); k++)
+        RippleCounter_Window[k] = RippleCounter_Window[size + k];
+
+    RippleCounter_ProcessCycles = CycleCounter_Get() - start;
+    if (RippleCounter_ProcessCycles > RippleCounter_ProcessMaxCycles)
+        RippleCounter_ProcessMaxCycles = RippleCounter_ProcessCycles;
+}
+
+/*
+ * Description :
+ * Return the signed ripple count.
+ */
+int32_t RippleCounter_GetCount(void)
+{
+    return RippleCounter_Count;
+}
+
+/*
+ * Description :
+ * Overwrite the ripple count.
+ */
+void RippleCounter_SetCount(int32_t count)
+{
+    RippleCounter_Count = count;
+}
+
+/*
+ * Description :
+ * Return the ripple frequency measured between the last two peaks, in Hz.
+ */
+uint32_t RippleCounter_GetFrequencyHz(void)
+{
+    uint32_t periodSamples = RippleCounter_PeriodSamples;
+
+    if ((periodSamples == 0) || (RippleCounter_Config == NULL))
+        return 0;
+
+    return RippleCounter_Config->sampleRateHz / periodSamples;
+}
+
+/*
+ * Description :
+ * Return the ripple period measured between the last two peaks, in microseconds.
+ */
+uint32_t RippleCounter_GetPeriodUs(void)
+{
+    uint32_t periodSamples = RippleCounter_PeriodSamples;
+
+    if ((periodSamples == 0) || (RippleCounter_Config == NULL))
+        return 0;
+
+    return (periodSamples * 1000000U) / RippleCounter_Config->sampleRateHz;
+}
+
+/*
+ * Description :
+ * Return the CPU cycles spent on the last block and the worst block.
+ */
+uint32_t RippleCounter_GetProcessCycles(void)
+{
+    return RippleCounter_ProcessCycles;
+}
+
+uint32_t RippleCounter_GetProcessMaxCycles(void)
+{
+    return RippleCounter_ProcessMaxCycles;
+}
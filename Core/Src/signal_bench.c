@@ -0,0 +1,156 @@
+/******************************************************************************
+ *
+ * Module: SIGNAL BENCH
+ *
+ * File Name: signal_bench.c
+ *
+ * Description: Source file for the ISR-to-task signalling benchmark.
+ *
+ *   The interrupt takes a DWT timestamp just before the give; the receiver takes
+ *   the difference as soon as its take returns. The receiver runs above the
+ *   calling task, so it is always blocked when the interrupt fires and every
+ *   sample includes the unblocking, the scheduler and the context switch.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#include "signal_bench.h"
+#include "semphr.h"
+#include "cycle_counter.h"
+
+/*******************************************************************************
+ *                           Private Variables                                 *
+ *******************************************************************************/
+
+#define SIGNAL_BENCH_RECEIVER_PRIORITY   (configMAX_PRIORITIES - 1)
+#define SIGNAL_BENCH_RECEIVER_STACK      (128U)
+
+SignalBench_ResultTypeDef SignalBench_Results[SIGNAL_BENCH_NUM_METHODS];
+
+static SemaphoreHandle_t SignalBench_Semaphore;
+static TaskHandle_t SignalBench_Receiver;
+static volatile SignalBench_Method_e SignalBench_Method;
+static volatile uint32_t SignalBench_GiveTimestamp;
+
+/*******************************************************************************
+ *                           Private Functions                                 *
+ *******************************************************************************/
+
+static void SignalBench_ReceiverTask(void *pvParameters)
+{
+    uint32_t iterations = (uint32_t)pvParameters;
+    SignalBench_ResultTypeDef *result;
+    uint64_t totalCycles;
+    uint32_t cycles;
+    uint32_t method;
+    uint32_t i;
+
+    for (method = 0; method < SIGNAL_BENCH_NUM_METHODS; method++)
+    {
+        result = &SignalBench_Results[method];
+        totalCycles = 0;
+
+        for (i = 0; i < iterations; i++)
+        {
+            if (method == SIGNAL_BENCH_SEMAPHORE)
+                xSemaphoreTake(SignalBench_Semaphore, portMAX_DELAY);
+            else
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+            cycles = CycleCounter_Get() - SignalBench_GiveTimestamp;
+
+            totalCycles += cycles;
+            if (cycles < result->minCycles)
+                result->minCycles = cycles;
+            if (cycles > result->maxCycles)
+                result->maxCycles = cycles;
+            result->samples++;
+        }
+
+        result->averageCycles = (uint32_t)(totalCycles / iterations);
+    }
+
+    SignalBench_Receiver = NULL;
+    vTaskDelete(NULL);
+}
+
+/*******************************************************************************
+ *                           Functions Definitions                             *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Run the benchmark from a task (priority below configMAX_PRIORITIES - 1).
+ *
+ * Parameters:
+ * - iterations: Signals per method.
+ *
+ * Return:
+ * - BaseType_t: pdPASS if the benchmark ran.
+ */
+BaseType_t SignalBench_Run(uint32_t iterations)
+{
+    uint32_t method;
+    uint32_t i;
+
+    if ((iterations == 0) || (uxTaskPriorityGet(NULL) >= SIGNAL_BENCH_RECEIVER_PRIORITY))
+        return pdFAIL;
+
+    if (SignalBench_Semaphore == NULL)
+        SignalBench_Semaphore = xSemaphoreCreateBinary();   // Created empty
+    if (SignalBench_Semaphore == NULL)
+        return pdFAIL;
+
+    for (method = 0; method < SIGNAL_BENCH_NUM_METHODS; method++)
+    {
+        SignalBench_Results[method].samples = 0;
+        SignalBench_Results[method].minCycles = UINT32_MAX;
+        SignalBench_Results[method].maxCycles = 0;
+        SignalBench_Results[method].averageCycles = 0;
+    }
+
+    if (xTaskCreate(SignalBench_ReceiverTask, "sigbench", SIGNAL_BENCH_RECEIVER_STACK, (void *)iterations,
+            SIGNAL_BENCH_RECEIVER_PRIORITY, &SignalBench_Receiver) != pdPASS)
+        return pdFAIL;
+
+    /* Highest priority allowed to call the FromISR API */
+    HAL_NVIC_SetPriority(SIGNAL_BENCH_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(SIGNAL_BENCH_IRQn);
+    EXTI->IMR |= SIGNAL_BENCH_EXTI_LINE;
+
+    /* The receiver preempts this task at the end of every interrupt and blocks again
+     * (or ends) before the next one is pended */
+    for (method = 0; method < SIGNAL_BENCH_NUM_METHODS; method++)
+    {
+        SignalBench_Method = (SignalBench_Method_e)method;
+        for (i = 0; i < iterations; i++)
+            EXTI->SWIER = SIGNAL_BENCH_EXTI_LINE;
+    }
+
+    EXTI->IMR &= ~SIGNAL_BENCH_EXTI_LINE;
+    HAL_NVIC_DisableIRQ(SIGNAL_BENCH_IRQn);
+
+    return pdPASS;
+}
+
+/*
+ * Description :
+ * Benchmark interrupt: timestamp, then give to the receiver with the method under test.
+ */
+void SignalBench_IRQHandler(void)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    if (SignalBench_Receiver == NULL)
+        return;
+
+    SignalBench_GiveTimestamp = CycleCounter_Get();
+
+    if (SignalBench_Method == SIGNAL_BENCH_SEMAPHORE)
+        xSemaphoreGiveFromISR(SignalBench_Semaphore, &xHigherPriorityTaskWoken);
+    else
+        vTaskNotifyGiveFromISR(SignalBench_Receiver, &xHigherPriorityTaskWoken);
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
@@ -0,0 +1,368 @@
+/******************************************************************************
+ *
+ * Module: SPEED MONITOR
+ *
+ * File Name: speed_monitor.c
+ *
+ * Description: Source file for the speed-drop pinch detector.
+ *
+ *   Every clean close teaches the detector the normal pulse period at each
+ *   position of the travel (seals and guide friction make it position
+ *   dependent). A period longer than the learned one by more than the allowed
+ *   speed drop is a jam. The periods of a run go to a scratch profile first and
+ *   reach the reference only once the window closed up to the top limit switch,
+ *   like the friction map.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#include "speed_monitor.h"
+#include "cycle_counter.h"
+#include "timer_clock.h"
+#include "main.h"          // Error_Handler()
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+typedef enum
+{
+    SPEED_RUN_IDLE, SPEED_RUN_RECORDING, SPEED_RUN_COMPLETE
+} SpeedMonitor_RunState_e;
+
+/*******************************************************************************
+ *                           Private Variables                                 *
+ *******************************************************************************/
+
+static TIM_HandleTypeDef SpeedMonitor_TimerHandle;
+
+static const SpeedMonitor_ConfigTypeDef *SpeedMonitor_Config;
+
+static volatile uint32_t SpeedMonitor_Reference[SPEED_MONITOR_BINS];  // Learned period per bin, in us
+static volatile uint8_t SpeedMonitor_Runs[SPEED_MONITOR_BINS];        // Clean closes learned per bin (saturated)
+
+static uint32_t SpeedMonitor_RunSum[SPEED_MONITOR_BINS];     // Periods of the current run per bin, in us
+static uint16_t SpeedMonitor_RunCount[SPEED_MONITOR_BINS];   // 0 = bin not seen in this run
+static volatile SpeedMonitor_RunState_e SpeedMonitor_RunState;
+
+static volatile uint8_t SpeedMonitor_Armed;
+static volatile uint8_t SpeedMonitor_BlankingPeriods;
+static volatile uint8_t SpeedMonitor_Suspended;    // Duty cycle other than config->referenceSpeed
+static uint32_t SpeedMonitor_LastCapture;
+static uint8_t SpeedMonitor_HaveCapture;
+
+/*******************************************************************************
+ *                           Private Functions                                 *
+ *******************************************************************************/
+
+static inline uint32_t SpeedMonitor_Bin(uint16_t position)
+{
+    return ((uint32_t)((position > 1000U)? 1000U : position) * SPEED_MONITOR_BINS) / 1001U;
+}
+
+/* Merge the mean periods of a clean run into the reference */
+static void SpeedMonitor_Merge(void)
+{
+    uint32_t bin;
+    uint32_t period;
+    int32_t reference;
+
+    for (bin = 0; bin < SPEED_MONITOR_BINS; bin++)
+    {
+        if (SpeedMonitor_RunCount[bin] == 0)
+            continue;
+
+        period = SpeedMonitor_RunSum[bin] / SpeedMonitor_RunCount[bin];
+
+        if (SpeedMonitor_Runs[bin] == 0)
+        {
+            SpeedMonitor_Reference[bin] = period;
+        }
+        else
+        {
+            reference = (int32_t)SpeedMonitor_Reference[bin];
+            reference += ((int32_t)period - reference) >> SpeedMonitor_Config->learnShift;
+            SpeedMonitor_Reference[bin] = (uint32_t)reference;
+        }
+
+        /* Reference first: a check in between still sees the previous run count */
+        if (SpeedMonitor_Runs[bin] < UINT8_MAX)
+            SpeedMonitor_Runs[bin]++;
+    }
+}
+
+/*******************************************************************************
+ *                           Functions Definitions                             *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize the detector (references cleared, disarmed).
+ *
+ * Parameters:
+ * - config: Pointer to the detector settings (kept by reference).
+ *
+ * Return:
+ * - None
+ */
+void SpeedMonitor_Init(const SpeedMonitor_ConfigTypeDef *config)
+{
+    uint32_t i;
+
+    SpeedMonitor_Config = config;
+    SpeedMonitor_Armed = 0;
+    SpeedMonitor_RunState = SPEED_RUN_IDLE;
+
+    for (i = 0; i < SPEED_MONITOR_BINS; i++)
+    {
+        SpeedMonitor_Reference[i] = 0;
+        SpeedMonitor_Runs[i] = 0;
+        SpeedMonitor_RunSum[i] = 0;
+        SpeedMonitor_RunCount[i] = 0;
+    }
+}
+
+/*
+ * Description :
+ * Start the speed pulse input capture (1 us resolution, free-running 32-bit counter).
+ */
+void SpeedMonitor_StartCapture(void)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = { 0 };
+    TIM_IC_InitTypeDef sConfigIC = { 0 };
+
+    SpeedMonitor_HaveCapture = 0;
+
+    __SPEED_MONITOR_PORT_CLK_ENABLE();
+    __SPEED_MONITOR_TIMER_CLK_ENABLE();
+
+    GPIO_InitStruct.Pin = SPEED_MONITOR_PIN_ID;
+    GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+    GPIO_InitStruct.Pull = GPIO_PULLUP;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+    GPIO_InitStruct.Alternate = SPEED_MONITOR_PIN_AF;
+    HAL_GPIO_Init(SPEED_MONITOR_GPIO_PORT, &GPIO_InitStruct);
+
+    /* Free-running 32-bit microsecond counter */
+    SpeedMonitor_TimerHandle.Instance = SPEED_MONITOR_TIMER;
+    SpeedMonitor_TimerHandle.Init.Prescaler = (TimerClock_GetFrequency(SPEED_MONITOR_TIMER) / 1000000U) - 1U;
+    SpeedMonitor_TimerHandle.Init.CounterMode = TIM_COUNTERMODE_UP;
+    SpeedMonitor_TimerHandle.Init.Period = 0xFFFFFFFFU;
+    SpeedMonitor_TimerHandle.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    SpeedMonitor_TimerHandle.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+
+    if (HAL_TIM_IC_Init(&SpeedMonitor_TimerHandle) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    sConfigIC.ICPolarity = TIM_ICPOLARITY_RISING;
+    sConfigIC.ICSelection = TIM_ICSELECTION_DIRECTTI;
+    sConfigIC.ICPrescaler = SPEED_MONITOR_CAPTURE_PSC;
+    sConfigIC.ICFilter = SPEED_MONITOR_INPUT_FILTER;
+
+    if (HAL_TIM_IC_ConfigChannel(&SpeedMonitor_TimerHandle, &sConfigIC, SPEED_MONITOR_CHANNEL) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    /* Same priority as the other motor cut-off interrupts */
+    HAL_NVIC_SetPriority(SPEED_MONITOR_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(SPEED_MONITOR_IRQn);
+
+    if (HAL_TIM_IC_Start_IT(&SpeedMonitor_TimerHandle, SPEED_MONITOR_CHANNEL) != HAL_OK)
+    {
+        Error_Handler();
+    }
+}
+
+/*
+ * Description :
+ * Start recording a closing run.
+ */
+void SpeedMonitor_StartRun(void)
+{
+    uint32_t bin;
+
+    if ((SpeedMonitor_Config == NULL) || (SpeedMonitor_RunState != SPEED_RUN_IDLE))
+        return;
+
+    for (bin = 0; bin < SPEED_MONITOR_BINS; bin++)
+    {
+        SpeedMonitor_RunSum[bin] = 0;
+        SpeedMonitor_RunCount[bin] = 0;
+    }
+
+    SpeedMonitor_RunState = SPEED_RUN_RECORDING;
+}
+
+/*
+ * Description :
+ * End the closing run, a clean run is kept for SpeedMonitor_Service().
+ *
+ * Parameters:
+ * - clean: 1 for a clean close.
+ *
+ * Return:
+ * - None
+ */
+void SpeedMonitor_EndRun(uint8_t clean)
+{
+    if (SpeedMonitor_RunState != SPEED_RUN_RECORDING)
+        return;
+
+    SpeedMonitor_RunState = clean? SPEED_RUN_COMPLETE : SPEED_RUN_IDLE;
+}
+
+/*
+ * Description :
+ * Merge a clean run into the reference.
+ */
+void SpeedMonitor_Service(void)
+{
+    if ((SpeedMonitor_Config == NULL) || (SpeedMonitor_RunState != SPEED_RUN_COMPLETE))
+        return;
+
+    SpeedMonitor_Merge();
+    SpeedMonitor_RunState = SPEED_RUN_IDLE;
+}
+
+/*
+ * Description :
+ * Arm the detector, the first config->blankingPeriods periods are ignored.
+ */
+void SpeedMonitor_Arm(void)
+{
+    if (SpeedMonitor_Config == NULL)
+        return;
+
+    SpeedMonitor_BlankingPeriods = SpeedMonitor_Config->blankingPeriods;
+    SpeedMonitor_Suspended = 0;
+    SpeedMonitor_Armed = 1;
+}
+
+/*
+ * Description :
+ * Duty cycle set point of the running motor: the periods are only checked at
+ * config->referenceSpeed.
+ *
+ * Parameters:
+ * - speed: Duty cycle in percent.
+ *
+ * Return:
+ * - None
+ */
+void SpeedMonitor_SetSpeed(uint8_t speed)
+{
+    uint8_t suspended;
+
+    if (SpeedMonitor_Config == NULL)
+        return;
+
+    suspended = (speed != SpeedMonitor_Config->referenceSpeed);
+
+    /* Back at the reference: let the motor reach its speed first */
+    if (SpeedMonitor_Suspended && !suspended &&
+        (SpeedMonitor_BlankingPeriods < SpeedMonitor_Config->settlePeriods))
+        SpeedMonitor_BlankingPeriods = SpeedMonitor_Config->settlePeriods;
+
+    SpeedMonitor_Suspended = suspended;
+}
+
+/*
+ * Description :
+ * Disarm the detector.
+ */
+void SpeedMonitor_Disarm(void)
+{
+    SpeedMonitor_Armed = 0;
+}
+
+/*
+ * Description :
+ * Check one measured period against the reference of its position, then record it.
+ *
+ * Parameters:
+ * - periodUs: Time between two speed pulses, in microseconds.
+ * - position: Window position in 0.1 % (0 .. 1000).
+ *
+ * Return:
+ * - uint8_t: 1 if the speed dropped more than config->dropPercent below the reference.
+ */
+uint8_t SpeedMonitor_Check(uint32_t periodUs, uint16_t position)
+{
+    const SpeedMonitor_ConfigTypeDef *config = SpeedMonitor_Config;
+    uint32_t bin;
+    uint32_t reference;
+
+    if (!SpeedMonitor_Armed || SpeedMonitor_Suspended || (config == NULL) || (periodUs == 0))
+        return 0;
+
+    if (SpeedMonitor_BlankingPeriods != 0)
+    {
+        SpeedMonitor_BlankingPeriods--;
+        return 0;
+    }
+
+    bin = SpeedMonitor_Bin(position);
+
+    /* speed < reference speed * (100 - drop) / 100  <=>  period * (100 - drop) > reference period * 100 */
+    if (SpeedMonitor_Runs[bin] >= config->minimumRuns)
+    {
+        reference = SpeedMonitor_Reference[bin];
+        if ((uint64_t)periodUs * (100U - config->dropPercent) > (uint64_t)reference * 100U)
+        {
+            SpeedMonitor_Armed = 0;
+            return 1;    // The run ends with the jam: never merged
+        }
+    }
+
+    if ((SpeedMonitor_RunState == SPEED_RUN_RECORDING) && (SpeedMonitor_RunCount[bin] < UINT16_MAX))
+    {
+        SpeedMonitor_RunSum[bin] += periodUs;
+        SpeedMonitor_RunCount[bin]++;
+    }
+
+    return 0;
+}
+
+/*
+ * Description :
+ * Timer interrupt service: one capture every SPEED_MONITOR_CAPTURE_PSC edges.
+ */
+void SpeedMonitor_IRQHandler(void)
+{
+    uint32_t timestamp = CycleCounter_Get();
+    uint32_t capture;
+    uint32_t periodUs;
+
+    if (__HAL_TIM_GET_FLAG(&SpeedMonitor_TimerHandle, TIM_FLAG_CC1OF))
+    {
+        __HAL_TIM_CLEAR_FLAG(&SpeedMonitor_TimerHandle, TIM_FLAG_CC1OF);
+        SpeedMonitor_HaveCapture = 0;     // A capture was missed: the next period is unknown
+    }
+
+    if (!__HAL_TIM_GET_FLAG(&SpeedMonitor_TimerHandle, TIM_FLAG_CC1))
+        return;
+
+    capture = SPEED_MONITOR_TIMER->CCR1;  // Reading CCR1 clears the CC1 flag
+
+    periodUs = capture - SpeedMonitor_LastCapture;
+    SpeedMonitor_LastCapture = capture;
+
+    if (SpeedMonitor_HaveCapture)
+        SpeedMonitor_CaptureCallback(periodUs, timestamp);
+
+    SpeedMonitor_HaveCapture = 1;
+}
+
+/*
+ * Description :
+ * Capture notification. Weak: override it in the application.
+ */
+__weak void SpeedMonitor_CaptureCallback(uint32_t periodUs, uint32_t timestamp)
+{
+    UNUSED(periodUs);
+    UNUSED(timestamp);
+}
@@ -0,0 +1,51 @@
+/******************************************************************************
+ *
+ * Module: TIMER CLOCK
+ *
+ * File Name: timer_clock.c
+ *
+ * Description: Source file for the timer kernel clock helper.
+ *
+ *   The timers do not run from the core clock but from their APB clock, times
+ *   two as soon as that APB is divided. Every timer setup goes through this
+ *   one function, so changing a bus prescaler in SystemClock_Config() keeps
+ *   the PWM, sampling and trigger rates right.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#include "timer_clock.h"
+
+/*******************************************************************************
+ *                           Functions Definitions                             *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Return the kernel clock of a timer.
+ *
+ * Parameters:
+ * - instance: Timer instance (TIM1 ... TIM14).
+ *
+ * Return:
+ * - uint32_t: Timer clock in Hz.
+ */
+uint32_t TimerClock_GetFrequency(const TIM_TypeDef *instance)
+{
+    uint32_t pclk;
+    uint8_t divided;
+
+    if ((instance == TIM1) || (instance == TIM8) || (instance == TIM9) || (instance == TIM10) || (instance == TIM11))
+    {
+        pclk = HAL_RCC_GetPCLK2Freq();
+        divided = ((RCC->CFGR & RCC_CFGR_PPRE2) != RCC_CFGR_PPRE2_DIV1);
+    }
+    else
+    {
+        pclk = HAL_RCC_GetPCLK1Freq();
+        divided = ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1);
+    }
+
+    return divided? (2U * pclk) : pclk;
+}
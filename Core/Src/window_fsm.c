@@ -0,0 +1,145 @@
+/******************************************************************************
+ *
+ * Module: WINDOW FSM
+ *
+ * File Name: window_fsm.c
+ *
+ * Description: Source file for the table-driven window panel state machine.
+ *
+ *   The transitions are a const [state][event] table (kept in flash). An empty
+ *   entry hands the event to the parent state, so the events shared by several
+ *   states (jam, lock, end of travel) are written once on a superstate.
+ *
+ * Author: Mostafa Mahmoud
+ *
+ *******************************************************************************/
+
+#include "window_fsm.h"
+#include "cycle_counter.h"
+
+/*******************************************************************************
+ *                           Private Variables                                 *
+ *******************************************************************************/
+
+#define T(nextState, motorAction)   { (uint8_t)(WINDOW_STATE_##nextState), (uint8_t)(WINDOW_ACTION_##motorAction) }
+
+static const uint8_t WindowFsm_Parent[WINDOW_NUM_STATES] = {
+    [WINDOW_STATE_IDLE]         = WINDOW_STATE_ACTIVE,
+    [WINDOW_STATE_MANUAL_UP]    = WINDOW_STATE_MOVING,
+    [WINDOW_STATE_AUTO_UP]      = WINDOW_STATE_MOVING,
+    [WINDOW_STATE_MANUAL_DOWN]  = WINDOW_STATE_MOVING,
+    [WINDOW_STATE_AUTO_DOWN]    = WINDOW_STATE_MOVING,
+    [WINDOW_STATE_MOVING]       = WINDOW_STATE_ACTIVE,
+};
+
+static const WindowFsm_TransitionTypeDef WindowFsm_Table[WINDOW_NUM_STATES][WINDOW_NUM_EVENTS] = {
+    /* The window moves at press-down, the travel mode is decided at release */
+    [WINDOW_STATE_IDLE] = {
+        [WINDOW_EVT_UP_PRESS]             = T(MANUAL_UP, UP),
+        [WINDOW_EVT_DOWN_PRESS]           = T(MANUAL_DOWN, DOWN),
+    },
+    /* While a button is held the other one is ignored. A double press (tap, tap) stops the
+     * one-touch travel started by its first tap */
+    [WINDOW_STATE_MANUAL_UP] = {
+        [WINDOW_EVT_UP_RELEASE_SHORT]     = T(AUTO_UP, NONE),
+        [WINDOW_EVT_UP_RELEASE_LONG]      = T(IDLE, STOP),
+        [WINDOW_EVT_UP_RELEASE_DOUBLE]    = T(IDLE, STOP),
+        [WINDOW_EVT_DOWN_PRESS]           = T(MANUAL_UP, NONE),
+    },
+    [WINDOW_STATE_MANUAL_DOWN] = {
+        [WINDOW_EVT_DOWN_RELEASE_SHORT]   = T(AUTO_DOWN, NONE),
+        [WINDOW_EVT_DOWN_RELEASE_LONG]    = T(IDLE, STOP),
+        [WINDOW_EVT_DOWN_RELEASE_DOUBLE]  = T(IDLE, STOP),
+        [WINDOW_EVT_UP_PRESS]             = T(MANUAL_DOWN, NONE),
+    },
+    /* A new press during a one-touch travel takes over (same or opposite direction) */
+    [WINDOW_STATE_AUTO_UP] = {
+        [WINDOW_EVT_UP_PRESS]             = T(MANUAL_UP, UP),
+        [WINDOW_EVT_DOWN_PRESS]           = T(MANUAL_DOWN, DOWN),
+    },
+    [WINDOW_STATE_AUTO_DOWN] = {
+        [WINDOW_EVT_UP_PRESS]             = T(MANUAL_UP, UP),
+        [WINDOW_EVT_DOWN_PRESS]           = T(MANUAL_DOWN, DOWN),
+    },
+    [WINDOW_STATE_MOVING] = {
+        [WINDOW_EVT_TRAVEL_END]           = T(IDLE, NONE),
+        [WINDOW_EVT_LOCK]                 = T(LOCKED, STOP),   // No release edge will end the travel
+    },
+    [WINDOW_STATE_ACTIVE] = {
+        [WINDOW_EVT_JAM]                  = T(JAM_REVERSE, NONE),  // The jam task owns the motor
+        [WINDOW_EVT_LOCK]                 = T(LOCKED, NONE),
+    },
+    [WINDOW_STATE_JAM_REVERSE] = {
+        [WINDOW_EVT_JAM_END]              = T(IDLE, NONE),
+    },
+    [WINDOW_STATE_LOCKED] = {
+        [WINDOW_EVT_UNLOCK]               = T(IDLE, NONE),
+    },
+};
+
+#undef T
+
+/*******************************************************************************
+ *                           Functions Definitions                             *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize a panel state machine in WINDOW_STATE_IDLE.
+ */
+void WindowFsm_Init(WindowFsm_TypeDef *fsm)
+{
+    fsm->state = WINDOW_STATE_IDLE;
+    fsm->dispatchCycles = 0;
+    fsm->maxDispatchCycles = 0;
+}
+
+/*
+ * Description :
+ * Dispatch one event to the current state or its nearest superstate handling it.
+ *
+ * Parameters:
+ * - fsm: Pointer to the panel state machine.
+ * - event: Event to dispatch.
+ *
+ * Return:
+ * - WindowFsm_Action_e: Motor action of the transition (WINDOW_ACTION_NONE if the event is ignored).
+ */
+WindowFsm_Action_e WindowFsm_Dispatch(WindowFsm_TypeDef *fsm, WindowFsm_Event_e event)
+{
+    uint32_t start = CycleCounter_Get();
+    const WindowFsm_TransitionTypeDef *transition;
+    uint8_t state = (uint8_t)fsm->state;
+    WindowFsm_Action_e action = WINDOW_ACTION_NONE;
+
+    if (event >= WINDOW_NUM_EVENTS)
+        return WINDOW_ACTION_NONE;
+
+    /* At most two levels above a leaf state */
+    while (state != WINDOW_STATE_NONE)
+    {
+        transition = &WindowFsm_Table[state][event];
+        if (transition->next != WINDOW_STATE_NONE)
+        {
+            fsm->state = (WindowFsm_State_e)transition->next;
+            action = (WindowFsm_Action_e)transition->action;
+            break;
+        }
+        state = WindowFsm_Parent[state];
+    }
+
+    fsm->dispatchCycles = CycleCounter_Get() - start;
+    if (fsm->dispatchCycles > fsm->maxDispatchCycles)
+        fsm->maxDispatchCycles = fsm->dispatchCycles;
+
+    return action;
+}
+
+/*
+ * Description :
+ * Return 1 if the state is one of the moving states.
+ */
+uint8_t WindowFsm_IsMoving(WindowFsm_State_e state)
+{
+    return (WindowFsm_Parent[state] == WINDOW_STATE_MOVING)? 1U : 0U;
+}
@@ -6,42 +6,90 @@
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
 ../Core/Src/button.c \
+../Core/Src/current_sense.c \
+../Core/Src/cycle_counter.c \
 ../Core/Src/dc_motor.c \
+../Core/Src/debounce.c \
+../Core/Src/encoder.c \
+../Core/Src/event_ring.c \
+../Core/Src/exti_dispatch.c \
 ../Core/Src/freertos.c \
+../Core/Src/friction_map.c \
 ../Core/Src/led.c \
 ../Core/Src/limit_switch.c \
 ../Core/Src/main.c \
+../Core/Src/pid.c \
+../Core/Src/position_estimator.c \
+../Core/Src/press_classifier.c \
+../Core/Src/rate_group.c \
+../Core/Src/ripple_counter.c \
+../Core/Src/signal_bench.c \
+../Core/Src/speed_monitor.c \
 ../Core/Src/stm32f4xx_hal_msp.c \
 ../Core/Src/stm32f4xx_it.c \
 ../Core/Src/syscalls.c \
 ../Core/Src/sysmem.c \
-../Core/Src/system_stm32f4xx.c 
+../Core/Src/system_stm32f4xx.c \
+../Core/Src/timer_clock.c \
+../Core/Src/window_fsm.c 
 
 OBJS += \
 ./Core/Src/button.o \
+./Core/Src/current_sense.o \
+./Core/Src/cycle_counter.o \
 ./Core/Src/dc_motor.o \
+./Core/Src/debounce.o \
+./Core/Src/encoder.o \
+./Core/Src/event_ring.o \
+./Core/Src/exti_dispatch.o \
 ./Core/Src/freertos.o \
+./Core/Src/friction_map.o \
 ./Core/Src/led.o \
 ./Core/Src/limit_switch.o \
 ./Core/Src/main.o \
+./Core/Src/pid.o \
+./Core/Src/position_estimator.o \
+./Core/Src/press_classifier.o \
+./Core/Src/rate_group.o \
+./Core/Src/ripple_counter.o \
+./Core/Src/signal_bench.o \
+./Core/Src/speed_monitor.o \
 ./Core/Src/stm32f4xx_hal_msp.o \
 ./Core/Src/stm32f4xx_it.o \
 ./Core/Src/syscalls.o \
 ./Core/Src/sysmem.o \
-./Core/Src/system_stm32f4xx.o 
+./Core/Src/system_stm32f4xx.o \
+./Core/Src/timer_clock.o \
+./Core/Src/window_fsm.o 
 
 C_DEPS += \
 ./Core/Src/button.d \
+./Core/Src/current_sense.d \
+./Core/Src/cycle_counter.d \
 ./Core/Src/dc_motor.d \
+./Core/Src/debounce.d \
+./Core/Src/encoder.d \
+./Core/Src/event_ring.d \
+./Core/Src/exti_dispatch.d \
 ./Core/Src/freertos.d \
+./Core/Src/friction_map.d \
 ./Core/Src/led.d \
 ./Core/Src/limit_switch.d \
 ./Core/Src/main.d \
+./Core/Src/pid.d \
+./Core/Src/position_estimator.d \
+./Core/Src/press_classifier.d \
+./Core/Src/rate_group.d \
+./Core/Src/ripple_counter.d \
+./Core/Src/signal_bench.d \
+./Core/Src/speed_monitor.d \
 ./Core/Src/stm32f4xx_hal_msp.d \
 ./Core/Src/stm32f4xx_it.d \
 ./Core/Src/syscalls.d \
 ./Core/Src/sysmem.d \
-./Core/Src/system_stm32f4xx.d 
+./Core/Src/system_stm32f4xx.d \
+./Core/Src/timer_clock.d \
+./Core/Src/window_fsm.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -51,7 +99,7 @@ Core/Src/%.o Core/Src/%.su Core/Src/%.cyclo: ../Core/Src/%.c Core/Src/subdir.mk
 clean: clean-Core-2f-Src
 
 clean-Core-2f-Src:
-	-$(RM) ./Core/Src/button.cyclo ./Core/Src/button.d ./Core/Src/button.o ./Core/Src/button.su ./Core/Src/dc_motor.cyclo ./Core/Src/dc_motor.d ./Core/Src/dc_motor.o ./Core/Src/dc_motor.su ./Core/Src/freertos.cyclo ./Core/Src/freertos.d ./Core/Src/freertos.o ./Core/Src/freertos.su ./Core/Src/led.cyclo ./Core/Src/led.d ./Core/Src/led.o ./Core/Src/led.su ./Core/Src/limit_switch.cyclo ./Core/Src/limit_switch.d ./Core/Src/limit_switch.o ./Core/Src/limit_switch.su ./Core/Src/main.cyclo ./Core/Src/main.d ./Core/Src/main.o ./Core/Src/main.su ./Core/Src/stm32f4xx_hal_msp.cyclo ./Core/Src/stm32f4xx_hal_msp.d ./Core/Src/stm32f4xx_hal_msp.o ./Core/Src/stm32f4xx_hal_msp.su ./Core/Src/stm32f4xx_it.cyclo ./Core/Src/stm32f4xx_it.d ./Core/Src/stm32f4xx_it.o ./Core/Src/stm32f4xx_it.su ./Core/Src/syscalls.cyclo ./Core/Src/syscalls.d ./Core/Src/syscalls.o ./Core/Src/syscalls.su ./Core/Src/sysmem.cyclo ./Core/Src/sysmem.d ./Core/Src/sysmem.o ./Core/Src/sysmem.su ./Core/Src/system_stm32f4xx.cyclo ./Core/Src/system_stm32f4xx.d ./Core/Src/system_stm32f4xx.o ./Core/Src/system_stm32f4xx.su
+	-$(RM) ./Core/Src/button.cyclo ./Core/Src/button.d ./Core/Src/button.o ./Core/Src/button.su ./Core/Src/current_sense.cyclo ./Core/Src/current_sense.d ./Core/Src/current_sense.o ./Core/Src/current_sense.su ./Core/Src/cycle_counter.cyclo ./Core/Src/cycle_counter.d ./Core/Src/cycle_counter.o ./Core/Src/cycle_counter.su ./Core/Src/dc_motor.cyclo ./Core/Src/dc_motor.d ./Core/Src/dc_motor.o ./Core/Src/dc_motor.su ./Core/Src/debounce.cyclo ./Core/Src/debounce.d ./Core/Src/debounce.o ./Core/Src/debounce.su ./Core/Src/encoder.cyclo ./Core/Src/encoder.d ./Core/Src/encoder.o ./Core/Src/encoder.su ./Core/Src/event_ring.cyclo ./Core/Src/event_ring.d ./Core/Src/event_ring.o ./Core/Src/event_ring.su ./Core/Src/exti_dispatch.cyclo ./Core/Src/exti_dispatch.d ./Core/Src/exti_dispatch.o ./Core/Src/exti_dispatch.su ./Core/Src/freertos.cyclo ./Core/Src/freertos.d ./Core/Src/freertos.o ./Core/Src/freertos.su ./Core/Src/friction_map.cyclo ./Core/Src/friction_map.d ./Core/Src/friction_map.o ./Core/Src/friction_map.su ./Core/Src/led.cyclo ./Core/Src/led.d ./Core/Src/led.o ./Core/Src/led.su ./Core/Src/limit_switch.cyclo ./Core/Src/limit_switch.d ./Core/Src/limit_switch.o ./Core/Src/limit_switch.su ./Core/Src/main.cyclo ./Core/Src/main.d ./Core/Src/main.o ./Core/Src/main.su ./Core/Src/pid.cyclo ./Core/Src/pid.d ./Core/Src/pid.o ./Core/Src/pid.su ./Core/Src/position_estimator.cyclo ./Core/Src/position_estimator.d ./Core/Src/position_estimator.o ./Core/Src/position_estimator.su ./Core/Src/press_classifier.cyclo ./Core/Src/press_classifier.d ./Core/Src/press_classifier.o ./Core/Src/press_classifier.su ./Core/Src/rate_group.cyclo ./Core/Src/rate_group.d ./Core/Src/rate_group.o ./Core/Src/rate_group.su ./Core/Src/ripple_counter.cyclo ./Core/Src/ripple_counter.d ./Core/Src/ripple_counter.o ./Core/Src/ripple_counter.su ./Core/Src/signal_bench.cyclo ./Core/Src/signal_bench.d ./Core/Src/signal_bench.o ./Core/Src/signal_bench.su ./Core/Src/speed_monitor.cyclo ./Core/Src/speed_monitor.d ./Core/Src/speed_monitor.o ./Core/Src/speed_monitor.su ./Core/Src/stm32f4xx_hal_msp.cyclo ./Core/Src/stm32f4xx_hal_msp.d ./Core/Src/stm32f4xx_hal_msp.o ./Core/Src/stm32f4xx_hal_msp.su ./Core/Src/stm32f4xx_it.cyclo ./Core/Src/stm32f4xx_it.d ./Core/Src/stm32f4xx_it.o ./Core/Src/stm32f4xx_it.su ./Core/Src/syscalls.cyclo ./Core/Src/syscalls.d ./Core/Src/syscalls.o ./Core/Src/syscalls.su ./Core/Src/sysmem.cyclo ./Core/Src/sysmem.d ./Core/Src/sysmem.o ./Core/Src/sysmem.su ./Core/Src/system_stm32f4xx.cyclo ./Core/Src/system_stm32f4xx.d ./Core/Src/system_stm32f4xx.o ./Core/Src/system_stm32f4xx.su ./Core/Src/timer_clock.cyclo ./Core/Src/timer_clock.d ./Core/Src/timer_clock.o ./Core/Src/timer_clock.su ./Core/Src/window_fsm.cyclo ./Core/Src/window_fsm.d ./Core/Src/window_fsm.o ./Core/Src/window_fsm.su
 
 .PHONY: clean-Core-2f-Src
 